@@ -5,31 +5,150 @@
 
 #include <Arduino.h>
 #include "ITLA_Registers.h"
+#include "ITLA_Units.h"
+#include "ITLA_ChannelPlan.h"
+#include "ITLA_Policies.h"
+#include "ITLA_Frame.h"
+#include "ITLA_Trace.h"
 
-class ITLA {
+// applyOperatingPoint() ftfRaw value meaning "leave FTF as it is"
+#define ITLA_FTF_UNCHANGED ((int16_t)-32768)
+
+#define ITLA_SERIAL_LEN 20
+
+class TuneProfiler;
+
+// Link health as seen by the driver
+enum ITLALinkState {
+    LINK_HEALTHY,    // last transaction succeeded
+    LINK_DEGRADED,   // recent failures, still trying every transaction
+    LINK_LOST        // transactions fail fast; serviceLink() tries to reacquire
+};
+
+// Static capabilities of one module, as raw register values. Read once per
+// unit and cached (see ITLA_Profile.h) so reconnects skip discovery.
+struct ModuleProfile {
+    char serial[ITLA_SERIAL_LEN];   // SN via AEA, NUL-terminated (at most ITLA_SERIAL_LEN - 1 chars)
+    uint16_t grid, grid2;           // GRID (0.1 GHz), GRID2 (MHz)
+    uint16_t fcf1, fcf2, fcf3;      // first channel: THz, GHz*10, MHz
+    uint16_t lfl1, lfl2, lfl3;      // lowest tunable frequency
+    uint16_t lfh1, lfh2, lfh3;      // highest tunable frequency
+    int16_t opsl, opsh;             // power range (dBm*100)
+    uint16_t ftfr;                  // fine-tune range (MHz)
+    uint16_t lgrid, lgrid2;         // minimum grid spacing
+};
+
+// The driver, parameterized on how it reaches the module (Transport), time
+// (Clock) and its log (Logger); see ITLA_Policies.h. Member definitions are
+// in ITLA_Impl.h: ITLA_.cpp instantiates the Arduino configuration (ITLA,
+// below), host code includes ITLA_Impl.h to build other combinations.
+template <class Transport, class Clock, class Logger>
+class BasicITLA {
 public:
+    static const unsigned long PENDING_TIMEOUT_MS = 30000;  // worst-case tune time
+    static const uint8_t LOST_AFTER_FAILURES = 3;           // consecutive failed frames
+    static const unsigned long REACQUIRE_INTERVAL_MS = 250; // probe period while lost
+    static const uint8_t PENDING_UNKNOWN = 0xFF;            // pendingFlags(): NOP read failed
+
 // hardware serial interface ITLA laser(serial1)
     // Constructor: allow passing the HardwareSerial (default Serial1 on Due)
-    ITLA(HardwareSerial &serial = Serial1); // &serial is a reference to avoid copying // ITLA(int x) its a constructor that initializes the ITLA object with a reference to a HardwareSerial object.
+    BasicITLA(Transport &serial = Serial1, const Clock &clock = Clock(), const Logger &logger = Logger()); // &serial is a reference to avoid copying
 
     // Initialize with optional debug flag. Returns true if module found. initialize communication with the ITLA module
     // Tries various baud rates until it gets a response.
-    // If verbose is true, prints debug info to Serial.
+    // If verbose is true, frames are traced to the logger (see setVerbose()).
     bool begin(bool verbose = false);
 
     // Read/write 16-bit register (returns data or throws on error)
+    // An AEA answer returns the string length with lastStatus() == 2.
     uint16_t readRegister(uint8_t reg);
-    void writeRegister(uint8_t reg, uint16_t value);
+    bool writeRegister(uint8_t reg, uint16_t value);   // true if the module accepted the write
+
+    // Error code (NOP bits 3:0, ITLA_ERR_*) of the last XE response, ITLA_ERR_OK otherwise
+    uint8_t lastErrorCode() const { return lastErr; }
+
+    // Status of the last transaction: 0 OK, 1 XE, 2 AEA, 3 CP, 0xFE CE, 0xFF no/bad response
+    uint8_t lastStatus() const { return lastSt; }
+
+    // Pending-operation flags (NOP bits 15:8); non-zero while the module is still tuning.
+    // PENDING_UNKNOWN if the NOP read failed (timeout, CE, link lost), never 0.
+    uint8_t pendingFlags();
+
+    // Link health. While LINK_LOST every transaction fails immediately;
+    // call serviceLink() from loop() to probe the module in the background
+    // (current baud first, then the other auto-baud rates).
+    ITLALinkState linkState() const { return link; }
+    void serviceLink();
+
+    // Current response timeout: two frame times at the active baud plus the
+    // smoothed module turnaround and four times its mean deviation.
+    uint32_t responseTimeoutUs() const;
+    uint32_t turnaroundUs() const { return srttUs; }
+
+    // Bytes skipped by the receive frame assembler to stay in step with the
+    // module (line noise, lost or duplicated bytes)
+    uint32_t rxResyncs() const { return rx.resyncs(); }
 
     // Laser control SENA bit
     void laserOn();      // Turn laser output on (sets SENA bit)
     void laserOff();     // Turn laser output off (clears SENA)
 
-    // Set/get optical power (dBm)
-    void setPower_dBm(double dBm);
-
-    // Set wavelength by frequency (THz)
-    void setFrequencyTHz(double freqTHz);
+    // Set/get optical power. Returns false if the module rejected the write.
+    bool setPower(PowerCdBm p);
+    PowerCdBm getPower();
+    bool setPower_dBm(double dBm);           // UI wrapper
+
+    // Set wavelength by frequency. Returns false if the module rejected the write
+    // (e.g. ITLA_ERR_CIP while a previous tune is still pending).
+    bool setFrequencyMHz(FreqMHz f);
+    FreqMHz getFrequencyMHz();               // from CHANNEL, exact
+    FreqMHz getFrequencyLFMHz();             // measured, from LF1/2/3
+    bool setFrequencyTHz(double freqTHz);    // UI wrapper
+
+    // Nearest channel for a frequency on the module's grid (reads GRID/FCF
+    // unless a profile is in use). With a profile the result is clamped to
+    // the tunable range. 0 if the grid is unknown.
+    uint32_t channelForMHz(FreqMHz f);
+    uint32_t channelForTHz(double freqTHz);
+
+    // Full discovery: SN plus every static capability register.
+    // Returns false if any read failed.
+    bool readProfile(ModuleProfile &p);
+
+    // Cheap check (two reads) that the attached module still has p's grid:
+    // GRID and FCF2 change when a unit is reconfigured, but two units of the
+    // same model read the same, so match the serial number first.
+    bool profileMatches(const ModuleProfile &p);
+
+    // Use cached grid/FCF values instead of reading them on every frequency
+    // call, and build the channel plan from the profile's FCF, grid and LFL/LFH
+    void useProfile(const ModuleProfile &p);
+    const ModuleProfile *profile() const { return haveProfile ? &prof : 0; }
+    const ChannelPlan &channelPlan() const { return plan; }
+
+    // Write CHANNELH then CHANNEL (the LSW write starts the tune). Channels
+    // outside a valid plan are refused without a write (lastErrorCode() RVE).
+    bool setChannel(uint32_t channel);
+    uint32_t getChannel();
+
+    // Poll NOP until no operation is pending. Returns false on timeout or when
+    // a poll fails, so a dead link never reads as a finished tune.
+    // firstPollMs skips polling while the operation is known to still be running.
+    bool waitPending(unsigned long timeoutMs = PENDING_TIMEOUT_MS, unsigned long firstPollMs = 0);
+
+    // The driver's clock, and a wait that runs the yield hook like the
+    // driver's own polling does, for callers timing module operations
+    unsigned long clockMs() const { return clock.ms(); }
+    void pause(unsigned long ms) { yieldLink(ms); }
+
+    // Measured tuning times (see ITLA_TuneProfiler.h); applyOperatingPoint()
+    // then starts polling for a retune when it is expected to finish
+    void useTuneProfiler(const TuneProfiler *p) { tuner = p; }
+
+    // Apply channel, POWER and FTF raw values, writing only what differs and
+    // waiting for the pending operation once. Pass ITLA_FTF_UNCHANGED to skip FTF.
+    // Returns the number of registers written, or 0xFF if a write failed.
+    uint8_t applyOperatingPoint(uint32_t channel, int16_t powerRaw, int16_t ftfRaw);
 
     // Get temperature (°C)
     double getTemperature();
@@ -40,21 +159,57 @@ public:
     // Read string from AEA register (e.g., SN)
     String readAEAString(uint8_t reg);
 
-    // Verbose debug output on Serial (USB)
+    // Verbose: every frame sent/received and each auto-baud attempt go to
+    // the logger's trace; errors and link changes are logged regardless.
     void setVerbose(bool on);
+
+    // Scheduler hook, called with ms = 0 before every frame and with the wait
+    // time instead of delay() while polling for a pending operation or letting
+    // the line settle after an auto-baud switch (the hook must then take that
+    // long). Lets a host link owner slip urgent frames in
+    // between the frames of a longer operation. Not called re-entrantly.
+    typedef void (*YieldHook)(void *ctx, unsigned long ms);
+    void setYieldHook(YieldHook fn, void *ctx) { yieldFn = fn; yieldCtx = ctx; }
     // ITLA.h additions
 
     
-double getPower_dBm();        // returns current power setpoint
-double getFrequencyTHz();     // returns current wavelength
+double getPower_dBm();        // returns current power setpoint (UI wrapper)
+double getFrequencyTHz();     // returns current wavelength (UI wrapper)
 bool isLaserOn();             // returns true if laser is on
-double getFrequencyLF();   // returns actual laser frequency from LF1/2/3
+double getFrequencyLF();   // returns actual laser frequency from LF1/2/3 (UI wrapper)
 
 
 private:
 // properties and methods and member functions
-    HardwareSerial &itlaSerial; // Reference to the serial port a permanent reference to avoid copying
-    bool verbose;
+    Transport &itlaSerial; // Reference to the serial port a permanent reference to avoid copying
+    Clock clock;
+    Logger logger;
+    ITLAFrameAssembler rx;
+    uint8_t lastErr;
+    uint8_t lastSt;
+    ModuleProfile prof;
+    ChannelPlan plan;       // from the profile; FCF and grid even if the range is unusable
+    bool haveProfile;
+    const TuneProfiler *tuner;
+
+    // Timeout estimation (TCP-style SRTT/RTTVAR on the module turnaround)
+    uint32_t frameUs;       // time to shift one 4-byte frame at the current baud
+    uint32_t srttUs;
+    uint32_t rttvarUs;
+    bool haveRtt;
+
+    // Link health state machine
+    ITLALinkState link;
+    uint8_t failStreak;
+    uint8_t baudIndex;
+    uint8_t lostProbes;
+    unsigned long lastProbeMs;
+    bool probing;           // let reacquisition probes through while LINK_LOST
+
+    YieldHook yieldFn;
+    void *yieldCtx;
+    bool inYield;
+    void yieldLink(unsigned long ms);   // hook, or plain delay(ms) without one
 
     // Send a raw command frame; returns raw 32-bit response.
     uint32_t sendCommandFrame(uint32_t frame);
@@ -75,8 +230,25 @@ private:
     // Read NOP register to get error field (bits 3:0).
     uint8_t getErrorCode();
 
+    // writeRegister() that waits out a CIP refusal once and retries
+    bool writeWhenReady(uint8_t reg, uint16_t value);
+
+    // First-channel frequency and grid spacing (profile or registers)
+    void gridAndFirst(FreqMHz &first, int32_t &gridMHz);
+
+    // Switch baud rate and reset the timeout estimate for it
+    void setBaud(uint8_t index);
+    void sampleTurnaround(uint32_t us);
+    void linkResult(bool ok);
+
     // Delay or check SRQ if needed for pending ops (not implemented here).
     // ...
 };
 
+// The Arduino build: hardware UART behind the wire-trace tap (idle unless
+// itlaTrace is started), core timing, deferred ring log
+typedef TracingTransport<HardwareSerial> ITLASerial;
+typedef BasicITLA<ITLASerial, ArduinoClock, ITLA_LOGGER> ITLA;
+extern template class BasicITLA<ITLASerial, ArduinoClock, ITLA_LOGGER>;
+
 #endif // ITLA_H
@@ -0,0 +1,120 @@
+// File: ITLA_BootTrace.cpp
+#include "ITLA_BootTrace.h"
+
+BootTrace bootTrace;
+
+BootTrace::BootTrace() : used(0), readyUs(0) {}
+
+uint8_t BootTrace::start(const char *name) {
+    if (used == BOOT_PHASES) return BOOT_NONE;
+    Phase &p = phases[used];
+    p.name = name;
+    p.startUs = micros();
+    p.endUs = 0;
+    return used++;
+}
+
+void BootTrace::end(uint8_t id) {
+    if (id >= used) return;
+    uint32_t t = micros();
+    phases[id].endUs = t ? t : 1;
+}
+
+void BootTrace::ready() {
+    uint32_t t = micros();
+    readyUs = t ? t : 1;
+}
+
+// ---------- Report ----------
+
+static const uint8_t BAR_WIDTH = 40;
+
+// us as ms with one decimal, right-aligned in width
+static void printMs(Print &out, uint32_t us, uint8_t width) {
+    char buf[12];
+    uint8_t n = 0;
+    uint32_t tenths = us / 100;
+    buf[n++] = (char)('0' + tenths % 10);
+    buf[n++] = '.';
+    uint32_t v = tenths / 10;
+    do {
+        buf[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (width-- > n) out.print(' ');
+    while (n) out.print(buf[--n]);
+}
+
+void BootTrace::report(Print &out) const {
+    uint32_t now = micros();
+    uint32_t span = readyUs;
+    for (uint8_t i = 0; i < used; i++) {
+        uint32_t e = phases[i].endUs ? phases[i].endUs : now;
+        if (e > span) span = e;
+    }
+    if (!span) span = 1;
+
+    out.print("Boot timeline (ms since reset), ");
+    if (readyUs) {
+        out.print("ready at ");
+        printMs(out, readyUs, 0);
+        out.println();
+    } else {
+        out.println("not ready yet");
+    }
+    out.println("phase           start      end      dur");
+    for (uint8_t i = 0; i < used; i++) {
+        const Phase &p = phases[i];
+        uint32_t e = p.endUs ? p.endUs : now;
+        uint8_t n = 0;
+        for (; p.name[n] && n < 12; n++) out.print(p.name[n]);
+        while (n++ < 12) out.print(' ');
+        printMs(out, p.startUs, 9);
+        if (p.endUs) printMs(out, e, 9);
+        else out.print("        -");
+        printMs(out, e - p.startUs, 9);
+
+        // Bar over [0, span]; overlapping phases share columns
+        uint8_t from = (uint8_t)((uint64_t)p.startUs * BAR_WIDTH / span);
+        uint8_t to = (uint8_t)((uint64_t)e * BAR_WIDTH / span);
+        if (to == from && to < BAR_WIDTH) to++;
+        out.print("  |");
+        for (uint8_t c = 0; c < to; c++) out.print(c < from ? ' ' : '#');
+        out.println();
+    }
+}
+
+// ---------- Overlapped steps ----------
+
+BootSteps::BootSteps() : used(0), next(0) {}
+
+bool BootSteps::add(const char *name, Step fn) {
+    if (used == BOOT_STEPS) return false;
+    steps[used] = fn;
+    names[used] = name;
+    used++;
+    return true;
+}
+
+bool BootSteps::runNext() {
+    if (next >= used) return false;
+    uint8_t i = next++;
+    uint8_t id = bootTrace.start(names[i]);
+    steps[i]();
+    bootTrace.end(id);
+    return true;
+}
+
+void BootSteps::finish() {
+    while (runNext()) {}
+}
+
+void BootSteps::yieldHook(void *ctx, unsigned long ms) {
+    // ms 0 is the call before each frame: nothing to wait for, so no work
+    if (ms == 0) return;
+    BootSteps *s = (BootSteps *)ctx;
+    unsigned long t0 = millis();
+    while (millis() - t0 < ms && s->runNext()) {}
+    unsigned long spent = millis() - t0;
+    if (spent < ms) delay(ms - spent);
+}
@@ -0,0 +1,74 @@
+// File: ITLA_BootTrace.h
+// Boot timeline. setup() brackets each phase with start()/end() (times are
+// micros() since reset), calls ready() once commands can be taken, and
+// report() prints the phases as a timeline afterwards, so a slow boot shows
+// where it went and which phases overlapped.
+//
+// BootSteps runs independent setup work (display init, config load...) in
+// the gaps of the ITLA probe instead of before or after it: queue the steps,
+// install BootSteps::yieldHook as the driver's yield hook for begin(), and
+// the steps run during the auto-baud settle waits (ITLA::setYieldHook). A
+// step runs to completion, so one that is longer than a wait stretches it;
+// finish() runs whatever is left once the probe returns. Steps must not use
+// the ITLA (the driver does not call its hook re-entrantly) and each step is
+// traced as a boot phase of its own.
+#ifndef ITLA_BOOT_TRACE_H
+#define ITLA_BOOT_TRACE_H
+
+#include <Arduino.h>
+
+#define BOOT_PHASES   12
+#define BOOT_STEPS    4
+#define BOOT_NONE     0xFF     // start() when all phases are taken
+
+class BootTrace {
+public:
+    BootTrace();
+
+    // Starts a phase now; name must stay valid (a literal)
+    uint8_t start(const char *name);
+    void end(uint8_t id);
+    // Boot is done: the sketch takes commands from here on
+    void ready();
+
+    bool isReady() const { return readyUs != 0; }
+    uint32_t readyMs() const { return readyUs / 1000; }
+    void report(Print &out) const;
+
+private:
+    struct Phase {
+        const char *name;
+        uint32_t startUs, endUs;   // endUs 0: still running
+    };
+    Phase phases[BOOT_PHASES];
+    uint8_t used;
+    uint32_t readyUs;
+};
+
+extern BootTrace bootTrace;
+
+class BootSteps {
+public:
+    typedef void (*Step)();
+
+    BootSteps();
+
+    // Queues fn, traced under name; false when the queue is full
+    bool add(const char *name, Step fn);
+    // Runs the next queued step; false when none was left
+    bool runNext();
+    // Runs every step still queued
+    void finish();
+    bool pending() const { return next < used; }
+
+    // ITLA yield hook, ctx a BootSteps: runs queued steps while the driver
+    // waits ms, and sleeps out what is left of the wait
+    static void yieldHook(void *ctx, unsigned long ms);
+
+private:
+    Step steps[BOOT_STEPS];
+    const char *names[BOOT_STEPS];
+    uint8_t used, next;
+};
+
+#endif // ITLA_BOOT_TRACE_H
@@ -0,0 +1,106 @@
+// File: ITLA_Buttons.cpp
+#include "ITLA_Buttons.h"
+
+ButtonPanel buttons;
+
+// attachInterrupt() takes a plain void(*)(), so one thunk per button
+static void isrUp()   { buttons.onEdge(BTN_UP); }
+static void isrDown() { buttons.onEdge(BTN_DOWN); }
+static void isrInc()  { buttons.onEdge(BTN_INC); }
+static void isrDec()  { buttons.onEdge(BTN_DEC); }
+static void isrOk()   { buttons.onEdge(BTN_OK); }
+
+static void (*const isrTable[BTN_COUNT])() = { isrUp, isrDown, isrInc, isrDec, isrOk };
+
+// Repeat period for each step size (coarse steps repeat slower so they stay controllable)
+static const unsigned long repeatInterval[] = { 80, 150, 400 };
+
+void ButtonPanel::begin(const uint8_t pins[BTN_COUNT], uint8_t mask) {
+    repeatMask = mask;
+    head = 0;
+    tail = 0;
+    overflows = 0;
+    for (uint8_t i = 0; i < BTN_COUNT; i++) {
+        btn[i].pin = pins[i];
+        btn[i].pressed = false;
+        btn[i].lastEdge = 0;
+        btn[i].nextRepeat = 0;
+        pinMode(pins[i], INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(pins[i]), isrTable[i], CHANGE);
+    }
+}
+
+// ISR context. Buttons are active-low (INPUT_PULLUP). An edge is only accepted
+// once the previous accepted edge is DEBOUNCE_MS old, so contact bounce on
+// either press or release collapses to a single transition.
+void ButtonPanel::onEdge(uint8_t id) {
+    Button &b = btn[id];
+    unsigned long now = millis();
+    bool down = digitalRead(b.pin) == LOW;
+    if (down == b.pressed) return;                   // no change in debounced state
+    if (now - b.lastEdge < DEBOUNCE_MS) return;      // still bouncing
+
+    b.pressed = down;
+    b.lastEdge = now;
+    if (!down) return;
+
+    uint8_t h = head;
+    uint8_t nextHead = (h + 1) & (QUEUE_SIZE - 1);
+    if (nextHead == tail) {
+        overflows = (uint16_t)(overflows + 1);   // no ++ on volatile (deprecated in C++20)
+        return;
+    }
+    queue[h] = id;
+    head = nextHead;   // publish after the slot is written
+}
+
+uint8_t ButtonPanel::stepFor(unsigned long heldMs) {
+    if (heldMs >= COARSE_AFTER_MS) return STEP_COARSE;
+    if (heldMs >= CHANNEL_AFTER_MS) return STEP_CHANNEL;
+    return STEP_FINE;
+}
+
+// A release that ended inside the debounce window of its press is never seen
+// by the ISR; catch it here so the button does not stay "held" forever.
+void ButtonPanel::releaseStuck(unsigned long now) {
+    for (uint8_t i = 0; i < BTN_COUNT; i++) {
+        Button &b = btn[i];
+        if (b.pressed && now - b.lastEdge >= DEBOUNCE_MS && digitalRead(b.pin) == HIGH) {
+            noInterrupts();
+            b.pressed = false;
+            b.lastEdge = now;
+            interrupts();
+        }
+    }
+}
+
+bool ButtonPanel::next(ButtonEvent &ev) {
+    unsigned long now = millis();
+
+    uint8_t t = tail;
+    if (t != head) {
+        ev.button = queue[t];
+        ev.step = STEP_FINE;
+        ev.repeat = false;
+        tail = (t + 1) & (QUEUE_SIZE - 1);
+        btn[ev.button].nextRepeat = now + REPEAT_DELAY_MS;
+        return true;
+    }
+
+    releaseStuck(now);
+
+    // Queue drained: synthesize auto-repeat for held buttons
+    for (uint8_t i = 0; i < BTN_COUNT; i++) {
+        Button &b = btn[i];
+        if (!(repeatMask & (1 << i)) || !b.pressed) continue;
+        if ((long)(now - b.nextRepeat) < 0) continue;
+
+        uint8_t step = stepFor(now - b.lastEdge);
+        ev.button = i;
+        ev.step = step;
+        ev.repeat = true;
+        b.nextRepeat = now + repeatInterval[step];
+        return true;
+    }
+    return false;
+}
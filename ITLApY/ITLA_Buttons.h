@@ -0,0 +1,78 @@
+// File: ITLA_Buttons.h
+// Interrupt-driven front panel buttons for the OLED controller.
+// Each pin gets a CHANGE interrupt with its own debounce timer; accepted presses
+// go into a small lock-free queue (ISR produces, loop() consumes) so nothing is
+// lost while the loop is blocked on a redraw or an ITLA transaction.
+// Held buttons auto-repeat and speed up the longer they are held.
+#ifndef ITLA_BUTTONS_H
+#define ITLA_BUTTONS_H
+
+#include <Arduino.h>
+
+enum ButtonId {
+    BTN_UP,
+    BTN_DOWN,
+    BTN_INC,
+    BTN_DEC,
+    BTN_OK,
+    BTN_COUNT
+};
+
+// Step size hint carried by auto-repeat events (fine -> coarse)
+enum ButtonStep {
+    STEP_FINE,      // first press and early repeats
+    STEP_CHANNEL,   // held a while: move one grid channel per event
+    STEP_COARSE     // held long: move in 1 THz / 1 dB jumps
+};
+
+struct ButtonEvent {
+    uint8_t button;   // ButtonId
+    uint8_t step;     // ButtonStep
+    bool repeat;      // true if generated by press-and-hold
+};
+
+class ButtonPanel {
+public:
+    static const unsigned long DEBOUNCE_MS = 20;
+    static const unsigned long REPEAT_DELAY_MS = 400;    // hold time before first repeat
+    static const unsigned long CHANNEL_AFTER_MS = 2000;  // hold time before channel steps
+    static const unsigned long COARSE_AFTER_MS = 4000;   // hold time before coarse steps
+
+    // pins[] is indexed by ButtonId; repeatMask has bit (1 << id) set for buttons that auto-repeat.
+    void begin(const uint8_t pins[BTN_COUNT], uint8_t repeatMask);
+
+    // Pop the next event (queued press or due auto-repeat). Returns false if none.
+    bool next(ButtonEvent &ev);
+
+    // Number of presses dropped because the queue was full (diagnostics).
+    uint16_t overflowCount() const { return overflows; }
+
+    // Called from the per-pin interrupt thunks.
+    void onEdge(uint8_t id);
+
+private:
+    static const uint8_t QUEUE_SIZE = 16;  // power of two
+
+    struct Button {
+        uint8_t pin;
+        volatile bool pressed;
+        volatile unsigned long lastEdge;   // last accepted press/release (ms)
+        unsigned long nextRepeat;          // loop()-side only
+    };
+
+    Button btn[BTN_COUNT];
+    uint8_t repeatMask;
+
+    // Single-producer (ISR) / single-consumer (loop) ring of ButtonIds.
+    volatile uint8_t queue[QUEUE_SIZE];
+    volatile uint8_t head;   // written by ISR
+    volatile uint8_t tail;   // written by loop()
+    volatile uint16_t overflows;
+
+    void releaseStuck(unsigned long now);
+    static uint8_t stepFor(unsigned long heldMs);
+};
+
+extern ButtonPanel buttons;
+
+#endif // ITLA_BUTTONS_H
@@ -0,0 +1,51 @@
+// File: ITLA_ChannelPlan.cpp
+#include "ITLA_ChannelPlan.h"
+
+ChannelPlan::ChannelPlan() : fcf(0), grid(0), firstCh(1), lastCh(0) {
+}
+
+void ChannelPlan::clear() {
+    fcf = 0;
+    grid = 0;
+    firstCh = 1;
+    lastCh = 0;
+}
+
+bool ChannelPlan::build(FreqMHz first, int32_t gridMHz, FreqMHz lowest, FreqMHz highest) {
+    clear();
+    fcf = first;
+    grid = gridMHz;
+    if (gridMHz <= 0 || highest < lowest) return false;
+
+    // Lowest channel at or above LFL (channel 1 is FCF; nothing below it is addressable)
+    int32_t lo = (int32_t)(lowest - first);
+    int32_t hi = (int32_t)(highest - first);
+    int32_t loCh = lo <= 0 ? 1 : (lo + gridMHz - 1) / gridMHz + 1;
+    if (hi < 0) return false;
+    int32_t hiCh = hi / gridMHz + 1;
+    if (hiCh < loCh) return false;
+
+    firstCh = (uint32_t)loCh;
+    lastCh = (uint32_t)hiCh;
+    return true;
+}
+
+uint32_t ChannelPlan::nearest(FreqMHz f) const {
+    if (!valid()) return 0;
+    if (f <= frequency(firstCh)) return firstCh;
+    if (f >= frequency(lastCh)) return lastCh;
+    return channelFor(fcf, grid, f);
+}
+
+uint32_t ChannelPlan::step(uint32_t ch, int32_t n) const {
+    if (!valid()) return 0;
+    int32_t target = (int32_t)ch + n;
+    if (target < (int32_t)firstCh) return firstCh;
+    if (target > (int32_t)lastCh) return lastCh;
+    return (uint32_t)target;
+}
+
+int32_t ChannelPlan::channelsFor(int32_t mhz) const {
+    if (grid <= 0 || mhz <= grid) return 1;
+    return (mhz + grid - 1) / grid;
+}
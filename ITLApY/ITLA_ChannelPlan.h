@@ -0,0 +1,52 @@
+// File: ITLA_ChannelPlan.h
+// The module's channel plan: first-channel frequency (FCF), grid spacing and
+// the channels that fall inside LFL..LFH. Built once when a profile is
+// attached; after that channel <-> frequency mapping is a multiply or one
+// 32-bit divide, and every channel handed out is one the module will accept.
+#ifndef ITLA_CHANNELPLAN_H
+#define ITLA_CHANNELPLAN_H
+
+#include <Arduino.h>
+#include "ITLA_Units.h"
+
+class ChannelPlan {
+public:
+    ChannelPlan();
+
+    // Derive the valid channel range. Returns false (plan invalid) if the
+    // grid is not positive or LFL..LFH holds no channel.
+    bool build(FreqMHz first, int32_t gridMHz, FreqMHz lowest, FreqMHz highest);
+    void clear();
+
+    bool valid() const { return lastCh >= firstCh && firstCh > 0; }
+    uint32_t firstChannel() const { return firstCh; }
+    uint32_t lastChannel() const { return lastCh; }
+    uint32_t count() const { return valid() ? lastCh - firstCh + 1 : 0; }
+    int32_t gridMHz() const { return grid; }
+    FreqMHz firstFrequency() const { return fcf; }   // channel 1, may lie below LFL
+
+    bool contains(uint32_t ch) const { return valid() && ch >= firstCh && ch <= lastCh; }
+
+    // Frequency of channel ch (no range check)
+    FreqMHz frequency(uint32_t ch) const { return channelFreq(fcf, grid, ch); }
+
+    // Nearest valid channel to f, clamped to the tunable range; 0 if invalid
+    uint32_t nearest(FreqMHz f) const;
+
+    // f moved onto the nearest valid channel
+    FreqMHz snap(FreqMHz f) const { return valid() ? frequency(nearest(f)) : f; }
+
+    // ch moved by n channels, clamped to the tunable range (iteration, menus)
+    uint32_t step(uint32_t ch, int32_t n) const;
+
+    // Number of channels covering at least `mhz` (at least 1)
+    int32_t channelsFor(int32_t mhz) const;
+
+private:
+    FreqMHz fcf;
+    int32_t grid;
+    uint32_t firstCh;
+    uint32_t lastCh;
+};
+
+#endif // ITLA_CHANNELPLAN_H
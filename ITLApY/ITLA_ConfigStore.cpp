@@ -0,0 +1,246 @@
+// File: ITLA_ConfigStore.cpp
+#include "ITLA_ConfigStore.h"
+
+// ---------- Storage medium ----------
+// The Due has no EEPROM; DueFlashStorage maps offsets onto the top of flash bank 1.
+// A flash write erases and reprograms the whole 256-byte page, so each record
+// gets a page of its own: an append never rewrites (or, torn, loses) another.
+#if defined(ARDUINO_ARCH_SAM)
+#include <DueFlashStorage.h>
+#define CFG_MAGIC 0xC6   // one record per page; journals of packed 0xC5 slots are ignored
+
+static DueFlashStorage flashStorage;
+
+static void mediumRead(uint32_t offset, void *buf, uint16_t len) {
+    memcpy(buf, flashStorage.readAddress(offset), len);
+}
+
+static bool mediumWrite(uint32_t offset, const void *buf, uint16_t len) {
+    return flashStorage.write(offset, (byte *)buf, len);
+}
+#elif defined(__linux__)
+// Host builds keep the same journal in a file (ITLA_CONFIG_FILE, default ./itla_config.bin)
+#include <stdio.h>
+#define CFG_MAGIC 0xC6   // the Due's layout
+
+static FILE *storeFile() {
+    static FILE *f = 0;
+    if (f) return f;
+    const char *path = getenv("ITLA_CONFIG_FILE");
+    if (!path) path = "itla_config.bin";
+    f = fopen(path, "r+b");
+    if (!f) {
+        // New file looks like erased flash
+        f = fopen(path, "w+b");
+        if (!f) return 0;
+        uint8_t erased[CFG_SLOT_STRIDE];
+        memset(erased, 0xFF, sizeof(erased));
+        for (uint16_t i = 0; i < CFG_SLOT_COUNT; i++) fwrite(erased, 1, sizeof(erased), f);
+        fflush(f);
+    }
+    return f;
+}
+
+static void mediumRead(uint32_t offset, void *buf, uint16_t len) {
+    FILE *f = storeFile();
+    if (!f || fseek(f, offset, SEEK_SET) != 0 || fread(buf, 1, len, f) != len) memset(buf, 0xFF, len);
+}
+
+static bool mediumWrite(uint32_t offset, const void *buf, uint16_t len) {
+    FILE *f = storeFile();
+    if (!f || fseek(f, offset, SEEK_SET) != 0) return false;
+    bool ok = fwrite(buf, 1, len, f) == len;
+    return fflush(f) == 0 && ok;
+}
+#else
+// The ring covers the whole EEPROM; on parts under 3.5 KB fewer record types keep it
+// at 4 slots per live type (CFG_STORE_SMALL)
+#include <EEPROM.h>
+#define CFG_MAGIC 0xC7   // whole-EEPROM ring; the fixed 1 KB 0xC5/0xC6 journals are ignored
+
+static void mediumRead(uint32_t offset, void *buf, uint16_t len) {
+    uint8_t *p = (uint8_t *)buf;
+    for (uint16_t i = 0; i < len; i++) p[i] = EEPROM.read(offset + i);
+}
+
+static bool mediumWrite(uint32_t offset, const void *buf, uint16_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+    for (uint16_t i = 0; i < len; i++) EEPROM.update(offset + i, p[i]);
+    return true;
+}
+#endif
+
+// ---------- Slot layout ----------
+struct SlotHeader {
+    uint8_t magic;
+    uint8_t type;
+    uint8_t version;
+    uint8_t len;
+    uint32_t seq;
+};
+
+struct Slot {
+    SlotHeader hdr;
+    uint8_t payload[CFG_PAYLOAD_MAX];
+    uint32_t crc;
+};
+
+// CRC-32 (IEEE, reflected), bitwise to keep flash use small; slots are only 60 bytes.
+static uint32_t crc32(const uint8_t *data, uint16_t len) {
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool slotValid(const Slot &s) {
+    if (s.hdr.magic != CFG_MAGIC) return false;
+    if (s.hdr.type >= CFG_REC_MAX_TYPES || s.hdr.len > CFG_PAYLOAD_MAX) return false;
+    return crc32((const uint8_t *)&s, sizeof(Slot) - sizeof(s.crc)) == s.crc;
+}
+
+// Sequence numbers only grow; compare with wrap-around in mind
+static bool seqNewer(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) > 0;
+}
+
+ConfigStore configStore;
+
+ConfigStore::ConfigStore()
+    : seq(0), head(0), slotCount(CFG_SLOT_COUNT), writes(0), stagedCount(0) {
+    for (uint8_t i = 0; i < CFG_REC_MAX_TYPES; i++) latest[i] = -1;
+}
+
+uint16_t ConfigStore::begin() {
+    uint16_t valid = 0;
+    bool any = false;
+    Slot s;
+
+    for (uint8_t i = 0; i < CFG_REC_MAX_TYPES; i++) latest[i] = -1;
+    uint32_t latestSeq[CFG_REC_MAX_TYPES];
+
+    for (uint16_t slot = 0; slot < slotCount; slot++) {
+        mediumRead((uint32_t)slot * CFG_SLOT_STRIDE, &s, sizeof(s));
+        if (!slotValid(s)) continue;
+        valid++;
+
+        uint8_t t = s.hdr.type;
+        if (latest[t] < 0 || seqNewer(s.hdr.seq, latestSeq[t])) {
+            latest[t] = slot;
+            latestSeq[t] = s.hdr.seq;
+        }
+        if (!any || seqNewer(s.hdr.seq, seq)) {
+            seq = s.hdr.seq;
+            head = (slot + 1) % slotCount;   // append after the newest record
+            any = true;
+        }
+    }
+    return valid;
+}
+
+bool ConfigStore::load(uint8_t type, uint8_t version, void *out, uint8_t len) {
+    if (type >= CFG_REC_MAX_TYPES) return false;
+
+    // A staged (not yet written) record is newer than anything in flash
+    for (uint8_t i = 0; i < stagedCount; i++) {
+        if (staged[i].type != type) continue;
+        if (staged[i].version != version || staged[i].len != len) return false;
+        memcpy(out, staged[i].data, len);
+        return true;
+    }
+
+    if (latest[type] < 0) return false;
+    Slot s;
+    mediumRead((uint32_t)latest[type] * CFG_SLOT_STRIDE, &s, sizeof(s));
+    if (!slotValid(s) || s.hdr.version != version || s.hdr.len != len) return false;
+    memcpy(out, s.payload, len);
+    return true;
+}
+
+void ConfigStore::stage(uint8_t type, uint8_t version, const void *data, uint8_t len) {
+    if (type >= CFG_REC_MAX_TYPES || len > CFG_PAYLOAD_MAX) return;
+    unsigned long now = millis();
+
+    uint8_t i = 0;
+    while (i < stagedCount && staged[i].type != type) i++;
+    if (i == stagedCount) {
+        if (stagedCount == STAGE_MAX) {
+            // Staging full of other types: make room by writing the oldest now
+            append(staged[0].type, staged[0].version, staged[0].data, staged[0].len);
+            dropStaged(0);
+            i = stagedCount;
+        }
+        stagedCount++;
+        staged[i].firstChange = now;
+    }
+    staged[i].type = type;
+    staged[i].version = version;
+    staged[i].len = len;
+    staged[i].lastChange = now;
+    memcpy(staged[i].data, data, len);
+}
+
+void ConfigStore::poll(unsigned long now) {
+    uint8_t i = 0;
+    while (i < stagedCount) {
+        Staged &st = staged[i];
+        if (now - st.lastChange >= COALESCE_MS || now - st.firstChange >= MAX_DEFER_MS) {
+            append(st.type, st.version, st.data, st.len);
+            dropStaged(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void ConfigStore::flush() {
+    while (stagedCount > 0) {
+        append(staged[0].type, staged[0].version, staged[0].data, staged[0].len);
+        dropStaged(0);
+    }
+}
+
+void ConfigStore::dropStaged(uint8_t index) {
+    for (uint8_t i = index + 1; i < stagedCount; i++) staged[i - 1] = staged[i];
+    stagedCount--;
+}
+
+bool ConfigStore::slotIsLive(uint16_t slot) const {
+    for (uint8_t t = 0; t < CFG_REC_MAX_TYPES; t++) {
+        if (latest[t] == (int16_t)slot) return true;
+    }
+    return false;
+}
+
+bool ConfigStore::append(uint8_t type, uint8_t version, const void *data, uint8_t len) {
+    // Find the next slot that does not hold the newest copy of any type. The
+    // current copy of `type` is kept too, so a torn write never loses it.
+    uint16_t slot = head;
+    uint16_t tries = 0;
+    while (slotIsLive(slot)) {
+        slot = (slot + 1) % slotCount;
+        if (++tries == slotCount) return false;   // more live types than slots
+    }
+
+    Slot s;
+    memset(&s, 0xFF, sizeof(s));
+    s.hdr.magic = CFG_MAGIC;
+    s.hdr.type = type;
+    s.hdr.version = version;
+    s.hdr.len = len;
+    s.hdr.seq = seq + 1;
+    memcpy(s.payload, data, len);
+    s.crc = crc32((const uint8_t *)&s, sizeof(Slot) - sizeof(s.crc));
+
+    if (!mediumWrite((uint32_t)slot * CFG_SLOT_STRIDE, &s, sizeof(s))) return false;
+
+    seq++;
+    writes++;
+    latest[type] = slot;
+    head = (slot + 1) % slotCount;
+    return true;
+}
@@ -0,0 +1,100 @@
+// File: ITLA_ConfigStore.h
+// Journaled, wear-leveled configuration store.
+// Records are appended into fixed-size slots laid out as a ring over a block of
+// flash (DueFlashStorage on the Due, a plain file on Linux hosts, EEPROM elsewhere),
+// one slot per flash page so that writing one never reprograms another. Each record carries a
+// type, a schema version, a sequence number and a CRC; on boot the newest valid
+// record of each type wins. Slots that still hold the newest record of some type
+// are skipped when the ring wraps, so rarely-changed records are never lost.
+// stage() only copies into RAM; bursts of changes are coalesced into one write
+// from poll() once things go quiet.
+#ifndef ITLA_CONFIGSTORE_H
+#define ITLA_CONFIGSTORE_H
+
+#include <Arduino.h>
+
+// Record types
+#define CFG_REC_CONFIG      0x00   // controller setpoints (ITLAtest)
+#define CFG_REC_PRESET_BASE 0x01   // operating-point presets, 0x01..0x08
+#define CFG_REC_PROFILE_BASE 0x10  // module capability profiles, 0x10..0x13
+#define CFG_REC_PROFILE_LAST 0x14  // index of the profile used last
+#define CFG_REC_MAX_TYPES   32
+
+#define CFG_SLOT_SIZE       64
+#define CFG_PAYLOAD_MAX     (CFG_SLOT_SIZE - 12)   // 8-byte header + 4-byte CRC
+
+// Journal size and slot spacing per medium (see ITLA_ConfigStore.cpp)
+#if defined(ARDUINO_ARCH_SAM) || defined(__linux__)
+#define CFG_STORE_SIZE      16384                  // 64 flash pages
+#define CFG_SLOT_STRIDE     256                    // one record per flash page
+#elif defined(E2END)
+#define CFG_STORE_SIZE      (E2END + 1)            // the whole EEPROM
+#define CFG_SLOT_STRIDE     CFG_SLOT_SIZE          // byte-writable, slots can be packed
+#else
+#define CFG_STORE_SIZE      1024
+#define CFG_SLOT_STRIDE     CFG_SLOT_SIZE
+#endif
+#define CFG_SLOT_COUNT      (CFG_STORE_SIZE / CFG_SLOT_STRIDE)
+
+// Wear only spreads over the slots not holding a live record. A store with
+// fewer than 4 slots per live type at the full counts (config, 8 presets,
+// 4 profiles, last profile) keeps one preset and one profile instead.
+#define CFG_LIVE_TYPES_FULL 14
+#define CFG_STORE_SMALL     (CFG_SLOT_COUNT < 4 * CFG_LIVE_TYPES_FULL)
+
+class ConfigStore {
+public:
+    static const unsigned long COALESCE_MS = 1000;   // write once changes stop for this long
+    static const unsigned long MAX_DEFER_MS = 5000;  // ...but never hold a change longer than this
+
+    ConfigStore();
+
+    // Scan the journal and index the newest record of each type.
+    // Returns the number of valid records found.
+    uint16_t begin();
+
+    // Copy the newest record of `type` into out. Fails if missing, or if the
+    // stored version/length does not match (caller falls back to defaults).
+    bool load(uint8_t type, uint8_t version, void *out, uint8_t len);
+
+    // Queue a record for a deferred write; a later stage() of the same type replaces it.
+    void stage(uint8_t type, uint8_t version, const void *data, uint8_t len);
+
+    // Write due staged records. Call from loop().
+    void poll(unsigned long now);
+
+    // Write all staged records now (e.g. before a deliberate reset).
+    void flush();
+
+    bool hasStaged() const { return stagedCount > 0; }
+    uint32_t slotWrites() const { return writes; }   // physical record writes since boot
+
+private:
+    static const uint8_t STAGE_MAX = 4;
+
+    struct Staged {
+        uint8_t type;
+        uint8_t version;
+        uint8_t len;
+        unsigned long firstChange;
+        unsigned long lastChange;
+        uint8_t data[CFG_PAYLOAD_MAX];
+    };
+
+    int16_t latest[CFG_REC_MAX_TYPES];   // slot of newest record per type, -1 if none
+    uint32_t seq;                        // sequence number of the newest record
+    uint16_t head;                       // next slot to try for an append
+    uint16_t slotCount;
+    uint32_t writes;
+
+    Staged staged[STAGE_MAX];
+    uint8_t stagedCount;
+
+    bool append(uint8_t type, uint8_t version, const void *data, uint8_t len);
+    bool slotIsLive(uint16_t slot) const;
+    void dropStaged(uint8_t index);
+};
+
+extern ConfigStore configStore;
+
+#endif // ITLA_CONFIGSTORE_H
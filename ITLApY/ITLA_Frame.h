@@ -0,0 +1,100 @@
+// File: ITLA_Frame.h
+// MSA frame codec shared by the firmware driver and the host tools.
+//   byte 0: BIP-4 (7:4), LstRsp / CE (3), 0 (2:1), R/W (0)   - command / response
+//           response bits 1:0 carry the status instead of R/W
+//   byte 1: register, bytes 2-3: data (MSB first)
+// BIP-4 covers the low nibble of byte 0 and bytes 1-3.
+// Header-only and C++11 so the Due build can use it unchanged.
+#ifndef ITLA_FRAME_H
+#define ITLA_FRAME_H
+
+#include <stdint.h>
+
+#define ITLA_FRAME_LEN 4
+
+// Response status (byte 0 bits 1:0)
+#define ITLA_ST_OK   0
+#define ITLA_ST_XE   1   // execution error, code in NOP bits 3:0
+#define ITLA_ST_AEA  2   // data is an AEA length; read the rest from EAR
+#define ITLA_ST_CP   3   // command pending
+
+constexpr uint8_t itlaBip4(uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {
+    return (uint8_t)(((((d0 & 0x0F) ^ d1 ^ d2 ^ d3) & 0xF0) >> 4) ^ (((d0 & 0x0F) ^ d1 ^ d2 ^ d3) & 0x0F));
+}
+
+inline void itlaEncode(uint8_t *out, uint8_t reg, bool write, uint16_t data, bool lstRsp = false) {
+    out[0] = (lstRsp ? 0x08 : 0x00) | (write ? 0x01 : 0x00);
+    out[1] = reg;
+    out[2] = (uint8_t)(data >> 8);
+    out[3] = (uint8_t)data;
+    out[0] |= (uint8_t)(itlaBip4(out[0], out[1], out[2], out[3]) << 4);
+}
+
+struct ITLAResponse {
+    uint8_t status;    // ITLA_ST_*
+    bool ce;           // module saw a communication error on the previous command
+    uint8_t reg;
+    uint16_t data;
+};
+
+inline bool itlaFrameValid(const uint8_t *in) {
+    return (in[0] >> 4) == itlaBip4(in[0], in[1], in[2], in[3]);
+}
+
+// Returns false (r untouched) if the BIP does not match
+inline bool itlaDecode(const uint8_t *in, ITLAResponse &r) {
+    if (!itlaFrameValid(in)) return false;
+    r.status = in[0] & 0x03;
+    r.ce = (in[0] & 0x08) != 0;
+    r.reg = in[1];
+    r.data = (uint16_t)((in[2] << 8) | in[3]);
+    return true;
+}
+
+// Finds response frames in a byte stream. Bytes go into a 4-byte window; a
+// window whose BIP-4 matches (and whose register is the one expected, if set)
+// is a frame. Otherwise the oldest byte is dropped and the window slides on,
+// so a lost, extra or corrupted byte costs at most the frame it hit instead
+// of misaligning every frame after it.
+class ITLAFrameAssembler {
+public:
+    ITLAFrameAssembler() : len(0), expected(-1), slips(0) {}
+
+    // Start a new exchange: forget partial bytes, accept only frames for reg
+    // (-1 for any register)
+    void reset(int16_t reg = -1) {
+        len = 0;
+        expected = reg;
+    }
+
+    // Returns true when the window holds a complete frame (see frame())
+    bool feed(uint8_t b) {
+        win[len++] = b;
+        if (len < ITLA_FRAME_LEN) return false;
+        if (itlaFrameValid(win) && (expected < 0 || win[1] == (uint8_t)expected)) {
+            len = 0;
+            return true;
+        }
+        win[0] = win[1];
+        win[1] = win[2];
+        win[2] = win[3];
+        len = ITLA_FRAME_LEN - 1;
+        slips++;
+        return false;
+    }
+
+    const uint8_t *frame() const { return win; }
+    uint32_t frameWord() const {
+        return ((uint32_t)win[0] << 24) | ((uint32_t)win[1] << 16) | ((uint32_t)win[2] << 8) | win[3];
+    }
+    // Bytes discarded while looking for a valid window
+    uint32_t resyncs() const { return slips; }
+
+private:
+    uint8_t win[ITLA_FRAME_LEN];
+    uint8_t len;
+    int16_t expected;
+    uint32_t slips;
+};
+
+#endif // ITLA_FRAME_H
@@ -0,0 +1,654 @@
+// File: ITLA_Impl.h
+// Member definitions of BasicITLA. Included once by ITLA_.cpp for the
+// Arduino configuration; include it (once per program and configuration)
+// to instantiate the driver with other policies.
+#ifndef ITLA_IMPL_H
+#define ITLA_IMPL_H
+
+#include "ITLA.h"
+#include "ITLA_TuneProfiler.h"
+#include "ITLA_Frame.h"
+#include "ITLA_Log.h"
+
+// Auto-baud candidates, also cycled through while reacquiring a lost link
+static const long ITLA_BAUDS[] = {4800, 9600, 19200, 38400, 57600, 115200};
+static const uint8_t ITLA_BAUD_COUNT = sizeof(ITLA_BAUDS) / sizeof(ITLA_BAUDS[0]);
+static const uint8_t ITLA_DEFAULT_BAUD = 1;   // 9600 per MSA
+
+// Turnaround assumed until the first response is measured, and timeout clamps
+static const uint32_t INITIAL_TURNAROUND_US = 10000;
+static const uint32_t MIN_TIMEOUT_US = 1000;
+static const uint32_t MAX_TIMEOUT_US = 100000;
+// Floor for the turnaround deviation: on a steady link rttvar would decay to
+// a few us and ordinary jitter would then trip the timeout
+static const uint32_t MIN_RTTVAR_US = 1000;
+
+// Constructor: use Serial1 by default
+template <class Transport, class Clock, class Logger>
+BasicITLA<Transport, Clock, Logger>::BasicITLA(Transport &serial, const Clock &clk, const Logger &lg)
+    : itlaSerial(serial), clock(clk), logger(lg), lastErr(ITLA_ERR_OK), lastSt(0), haveProfile(false), tuner(0),
+    frameUs(0), srttUs(INITIAL_TURNAROUND_US), rttvarUs(INITIAL_TURNAROUND_US / 2), haveRtt(false),
+    link(LINK_HEALTHY), failStreak(0), baudIndex(ITLA_DEFAULT_BAUD), lostProbes(0), lastProbeMs(0), probing(false),
+    yieldFn(0), yieldCtx(0), inYield(false)
+{
+    
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::setBaud(uint8_t index) {
+    baudIndex = index;
+    itlaSerial.begin(ITLA_BAUDS[index]);
+    // 4 bytes x 10 bits (start + 8 data + stop), rounded up
+    frameUs = (40UL * 1000000UL + ITLA_BAUDS[index] - 1) / ITLA_BAUDS[index];
+    srttUs = INITIAL_TURNAROUND_US;
+    rttvarUs = INITIAL_TURNAROUND_US / 2;
+    haveRtt = false;
+}
+
+template <class Transport, class Clock, class Logger>
+uint32_t BasicITLA<Transport, Clock, Logger>::responseTimeoutUs() const {
+    uint32_t t = 2 * frameUs + srttUs + 4 * rttvarUs;
+    if (t < MIN_TIMEOUT_US) t = MIN_TIMEOUT_US;
+    if (t > MAX_TIMEOUT_US) t = MAX_TIMEOUT_US;
+    return t;
+}
+
+// Jacobson/Karels: srtt += err/8, rttvar += (|err| - rttvar)/4, with rttvar
+// kept at or above max(srtt/4, MIN_RTTVAR_US)
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::sampleTurnaround(uint32_t us) {
+    if (!haveRtt) {
+        srttUs = us;
+        rttvarUs = us / 2;
+        haveRtt = true;
+    } else {
+        int32_t err = (int32_t)us - (int32_t)srttUs;
+        srttUs = (uint32_t)((int32_t)srttUs + err / 8);
+        int32_t absErr = err < 0 ? -err : err;
+        rttvarUs = (uint32_t)((int32_t)rttvarUs + (absErr - (int32_t)rttvarUs) / 4);
+    }
+    uint32_t floorUs = srttUs / 4 > MIN_RTTVAR_US ? srttUs / 4 : MIN_RTTVAR_US;
+    if (rttvarUs < floorUs) rttvarUs = floorUs;
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::linkResult(bool ok) {
+    ITLALinkState prev = link;
+    if (ok) {
+        failStreak = 0;
+        lostProbes = 0;
+        link = LINK_HEALTHY;
+    } else {
+        if (failStreak < 255) failStreak++;
+        link = failStreak >= LOST_AFTER_FAILURES ? LINK_LOST : LINK_DEGRADED;
+    }
+    if (link != prev) logger.event(LOG_LINK_STATE, link, 0, failStreak);
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::serviceLink() {
+    if (link != LINK_LOST) return;
+    unsigned long now = clock.ms();
+    if (now - lastProbeMs < REACQUIRE_INTERVAL_MS) return;
+    lastProbeMs = now;
+
+    // A few tries at the last good rate (module may just be rebooting),
+    // then walk the other rates in case it came back at its default
+    if (lostProbes >= 4) setBaud((baudIndex + 1) % ITLA_BAUD_COUNT);
+    else lostProbes++;
+
+    uint8_t st;
+    probing = true;
+    transact(ITLA_REG_NOP, false, 0, st);
+    probing = false;
+    if (st == 0) logger.event(LOG_LINK_REACQUIRED, 0, 0, ITLA_BAUDS[baudIndex]);
+}
+
+// Calculate BIP-4 checksum using lower nibble of data[0] and XOR logic
+template <class Transport, class Clock, class Logger>
+uint8_t BasicITLA<Transport, Clock, Logger>::calcBIP4(uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {
+    return itlaBip4(d0, d1, d2, d3);
+}
+
+// Form a 4-byte command packet with proper header, command, value, and BIP
+// (R/W is byte 0 bit 0, LstRsp bit 3; see ITLA_Frame.h)
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::formCommandPacket(uint8_t* outData, uint8_t command, uint16_t value, uint8_t isWrite, uint8_t lstRsp) {
+    itlaEncode(outData, command, isWrite, value, lstRsp);
+}
+
+// Send 4-byte command frame and receive 4-byte response
+template <class Transport, class Clock, class Logger>
+uint32_t BasicITLA<Transport, Clock, Logger>::sendCommandFrame(uint32_t frame) {
+    uint8_t command = (frame >> 16) & 0xFF;
+    uint16_t value = frame & 0xFFFF;
+    uint8_t writeFlag = (frame & (1UL << 24)) ? 1 : 0;
+
+    uint8_t data[4];
+    formCommandPacket(data, command, value, writeFlag, 0); // lstRsp = 0
+
+    // Frame tracing goes to the deferred log; printing here would shift the timing
+    logger.trace(LOG_TX_FRAME, command, value, writeFlag);
+
+    // Anything still buffered belongs to an earlier exchange (a late reply,
+    // line noise); drop it so it cannot be taken for this response
+    uint16_t stale = 0;
+    while (itlaSerial.available() > 0) {
+        itlaSerial.read();
+        stale++;
+    }
+    if (stale) logger.event(LOG_RX_STALE, command, 0, stale);
+    rx.reset(command);
+
+    itlaSerial.write(data, 4);
+
+    // Feed whatever has arrived to the frame assembler until it yields this
+    // register's response; timeout derived from baud and measured turnaround
+    uint32_t timeoutUs = responseTimeoutUs();
+    uint32_t slipsBefore = rx.resyncs();
+    unsigned long t0 = clock.us();
+    unsigned long elapsed = 0;
+    bool got = false;
+    while (!got && (elapsed = clock.us() - t0) < timeoutUs) {
+        for (int n = itlaSerial.available(); n > 0 && !got; n--) {
+            got = rx.feed((uint8_t)itlaSerial.read());
+        }
+    }
+    uint32_t slipped = rx.resyncs() - slipsBefore;
+
+    if (!got) {
+        if (slipped) {
+            // Bytes came back but no window passed BIP: noise, not a slow module
+            logger.event(LOG_BIP_ERROR, command, 0, slipped);
+        } else {
+            logger.event(LOG_RX_TIMEOUT, command, 0, timeoutUs);
+            // Back off in case the module is just slower than estimated
+            if (rttvarUs < MAX_TIMEOUT_US / 4) rttvarUs *= 2;
+        }
+        return 0xFFFFFFFF;
+    }
+    if (slipped) logger.event(LOG_RX_RESYNC, command, 0, slipped);
+    // Module turnaround = round trip minus the time both frames spend on the wire
+    sampleTurnaround(elapsed > 2 * frameUs ? elapsed - 2 * frameUs : 0);
+
+    uint32_t resp = rx.frameWord();
+    logger.trace(LOG_RX_FRAME, command, 0, resp);
+    return resp;
+}
+
+// Perform transaction: send command, get parsed data + status wrapper for send and receive
+template <class Transport, class Clock, class Logger>
+uint16_t BasicITLA<Transport, Clock, Logger>::transact(uint8_t reg, bool writeFlag, uint16_t data, uint8_t &status) {
+    uint32_t frame = 0;
+    frame |= (1UL << 26);                    // fixed bit 26 to 1 ,1 unsigned long  32 bit 00000100000000000000000000000000 0x04000000
+    if (writeFlag) frame |= (1UL << 24);     // R/W bit 24 set to 1 for write, 0 for read
+    frame |= ((uint32_t)reg << 16);          // register  0x12 << 16 = 0x00120000
+    frame |= data;                           // data
+
+    yieldLink(0);
+
+    // Fail fast while the link is down; serviceLink() probes in the background
+    if (link == LINK_LOST && !probing) {
+        status = lastSt = 0xFF;
+        return 0;
+    }
+
+    uint32_t raw = sendCommandFrame(frame);
+    if (raw == 0xFFFFFFFF) {
+        status = lastSt = 0xFF;
+        linkResult(false);
+        return 0;
+    }
+
+    bool CE = (raw & (1UL << 27));
+    if (CE) {
+        logger.event(LOG_CE_FLAG, reg);
+        status = lastSt = 0xFE;
+        linkResult(false);
+        return 0;
+    }
+    linkResult(true);
+
+    uint32_t payload = raw & 0x03FFFFFFUL;
+    status = lastSt = (payload >> 24) & 0x03;  // status bits 25:24
+    uint16_t respData = payload & 0xFFFF;
+
+    return respData;
+}
+
+
+//verbose mode is used to print debug information dbg = true enables verbose mode
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::begin(bool dbg) {
+    logger.setVerbose(dbg);
+
+    for (uint8_t i = 0; i < ITLA_BAUD_COUNT; ++i) {
+        setBaud(i);
+        yieldLink(50);   // line settle; boot work can run here
+        logger.trace(LOG_AUTOBAUD_TRY, i, 0, ITLA_BAUDS[i]);
+
+        uint8_t status;
+        probing = true;
+        transact(ITLA_REG_NOP, false, 0, status);
+        probing = false;
+        // Check status, not the returned value
+        if (status == 0) {
+            logger.event(LOG_AUTOBAUD_FOUND, i, 0, ITLA_BAUDS[i]);
+            return true;
+        }
+    }
+
+    // None responded—default back to 9600; serviceLink() keeps looking
+    setBaud(ITLA_DEFAULT_BAUD);
+    link = LINK_LOST;
+    logger.event(LOG_AUTOBAUD_FAILED, 0, 0, ITLA_BAUDS[ITLA_DEFAULT_BAUD]);
+    return false;
+}
+
+
+// additional check for baud rate detection in pdf its 9600 given as default 
+/*bool ITLA::begin(bool dbg) {
+    verbose = dbg;
+    const long bauds[] = {4800, 9600, 19200, 38400, 57600, 115200};
+    for (auto baud : bauds) {
+        itlaSerial.begin(baud);
+        delay(50);
+        if (verbose) {
+            Serial.print("Trying baud "); Serial.println(baud);
+        }
+        uint8_t status;
+        uint16_t val = transact(ITLA_REG_NOP, false, 0, status);
+        if (status == 0) {
+            if (verbose) {
+                Serial.print("Device responded at "); Serial.print(baud); Serial.println(" baud");
+            }
+            return true;
+        }
+    }
+    itlaSerial.begin(9600);
+    if (verbose) Serial.println("Failed auto-baud, defaulting to 9600");
+    return false;
+} */
+
+template <class Transport, class Clock, class Logger>
+uint16_t BasicITLA<Transport, Clock, Logger>::readRegister(uint8_t reg) {
+    uint8_t status;
+    uint16_t val = transact(reg, false, 0, status);
+    lastErr = ITLA_ERR_OK;
+    if (status == 2) return val;   // AEA: val is the string length, lastStatus() tells
+    if (status != 0) {
+        logger.event(LOG_READ_ERROR, reg, 0, status);
+        if (status == 1) {
+            lastErr = getErrorCode();
+            logger.event(LOG_EXEC_ERROR, reg, lastErr);
+        }
+        return 0;
+    }
+    return val;
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::writeRegister(uint8_t reg, uint16_t value) {
+    uint8_t status;
+    uint16_t ack = transact(reg, true, value, status);
+    lastErr = ITLA_ERR_OK;
+    if (status != 0) {
+        logger.event(LOG_WRITE_ERROR, reg, value, status);
+        if (status == 1) {
+            lastErr = getErrorCode();
+            logger.event(LOG_EXEC_ERROR, reg, lastErr);
+        }
+        return false;
+    }
+    return true;
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::laserOn() {
+    writeRegister(ITLA_REG_RESETA, 0x0008);
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::laserOff() {
+    writeRegister(ITLA_REG_RESETA, 0x0000);
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::setPower(PowerCdBm p) {
+    return writeRegister(ITLA_REG_POWER, (uint16_t)p);
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::setPower_dBm(double dBm) {
+    return setPower(powerFromDbm(dBm));
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::gridAndFirst(FreqMHz &first, int32_t &gridMHz) {
+    if (haveProfile) {
+        first = plan.firstFrequency();
+        gridMHz = plan.gridMHz();
+        return;
+    }
+    uint16_t grid_i = readRegister(ITLA_REG_GRID);
+    uint16_t grid_f = readRegister(ITLA_REG_GRID2);
+    uint16_t fcf1 = readRegister(ITLA_REG_FCF1);
+    uint16_t fcf2 = readRegister(ITLA_REG_FCF2);
+    uint16_t fcf3 = readRegister(ITLA_REG_FCF3);
+    gridMHz = gridFromRegs(grid_i, grid_f);
+    first = freqFromRegs(fcf1, fcf2, fcf3);
+}
+
+template <class Transport, class Clock, class Logger>
+uint32_t BasicITLA<Transport, Clock, Logger>::channelForMHz(FreqMHz f) {
+    if (plan.valid()) return plan.nearest(f);
+    FreqMHz first;
+    int32_t gridMHz;
+    gridAndFirst(first, gridMHz);
+    return channelFor(first, gridMHz, f);
+}
+
+template <class Transport, class Clock, class Logger>
+uint32_t BasicITLA<Transport, Clock, Logger>::channelForTHz(double freqTHz) {
+    return channelForMHz(freqFromTHz(freqTHz));
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::readProfile(ModuleProfile &p) {
+    memset(&p, 0, sizeof(p));
+    String sn = readAEAString(ITLA_REG_SN);
+    strncpy(p.serial, sn.c_str(), sizeof(p.serial) - 1);
+    p.serial[sizeof(p.serial) - 1] = '\0';
+
+    struct { uint8_t reg; uint16_t *dst; } regs[] = {
+        { ITLA_REG_GRID,  &p.grid },  { ITLA_REG_GRID2, &p.grid2 },
+        { ITLA_REG_FCF1,  &p.fcf1 },  { ITLA_REG_FCF2,  &p.fcf2 },  { ITLA_REG_FCF3, &p.fcf3 },
+        { ITLA_REG_LFL1,  &p.lfl1 },  { ITLA_REG_LFL2,  &p.lfl2 },  { ITLA_REG_LFL3, &p.lfl3 },
+        { ITLA_REG_LFH1,  &p.lfh1 },  { ITLA_REG_LFH2,  &p.lfh2 },  { ITLA_REG_LFH3, &p.lfh3 },
+        { ITLA_REG_OPSL,  (uint16_t *)&p.opsl }, { ITLA_REG_OPSH, (uint16_t *)&p.opsh },
+        { ITLA_REG_FTFR,  &p.ftfr },
+        { ITLA_REG_LGRID, &p.lgrid }, { ITLA_REG_LGRID2, &p.lgrid2 },
+    };
+    for (size_t i = 0; i < sizeof(regs) / sizeof(regs[0]); i++) {
+        *regs[i].dst = readRegister(regs[i].reg);
+        // RNI on optional registers (e.g. LGRID2 on older modules) is fine; a dead link is not
+        if (lastSt == 0xFF || lastSt == 0xFE) return false;
+    }
+    return p.serial[0] != '\0';
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::profileMatches(const ModuleProfile &p) {
+    uint16_t grid = readRegister(ITLA_REG_GRID);
+    if (lastSt != 0 || grid != p.grid) return false;
+    uint16_t fcf2 = readRegister(ITLA_REG_FCF2);
+    return lastSt == 0 && fcf2 == p.fcf2;
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::useProfile(const ModuleProfile &p) {
+    prof = p;
+    plan.build(freqFromRegs(p.fcf1, p.fcf2, p.fcf3), gridFromRegs(p.grid, p.grid2),
+               freqFromRegs(p.lfl1, p.lfl2, p.lfl3), freqFromRegs(p.lfh1, p.lfh2, p.lfh3));
+    haveProfile = true;
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::setFrequencyMHz(FreqMHz f) {
+    uint32_t channel = channelForMHz(f);
+    if (channel == 0) return false;   // grid unknown
+    return setChannel(channel);
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::setFrequencyTHz(double freqTHz) {
+    return setFrequencyMHz(freqFromTHz(freqTHz));
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::setChannel(uint32_t channel) {
+    // Don't spend two frames on a channel the module will refuse
+    if (plan.valid() && !plan.contains(channel)) {
+        lastErr = ITLA_ERR_RVE;
+        return false;
+    }
+
+    // Split into high/low 16 bits
+    uint16_t channelLS = channel & 0xFFFF;
+    uint16_t channelMS = (channel >> 16) & 0xFFFF;
+
+    // Write high word first, then low word
+    if (!writeRegister(ITLA_REG_CHANNELH, channelMS)) return false;  // 0x65
+    return writeRegister(ITLA_REG_CHANNEL, channelLS);               // 0x30
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::waitPending(unsigned long timeoutMs, unsigned long firstPollMs) {
+    unsigned long t0 = clock.ms();
+    if (firstPollMs > 0) yieldLink(firstPollMs < timeoutMs ? firstPollMs : timeoutMs);
+    for (;;) {
+        uint8_t flags = pendingFlags();
+        if (flags == 0) return true;
+        if (flags == PENDING_UNKNOWN) return false;
+        if (clock.ms() - t0 >= timeoutMs) return false;
+        yieldLink(10);
+    }
+}
+
+// Write a register, and if the module refuses because an earlier operation
+// is still pending (CIP), wait for it once and retry.
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::writeWhenReady(uint8_t reg, uint16_t value) {
+    if (writeRegister(reg, value)) return true;
+    if (lastErr != ITLA_ERR_CIP) return false;
+    if (!waitPending(PENDING_TIMEOUT_MS)) return false;
+    return writeRegister(reg, value);
+}
+
+// Move to an operating point touching only the registers that differ from
+// what the module already has. Power goes first so its settling overlaps the
+// tune; FTF goes last because a channel change may clear it. Only one
+// pending-op wait is paid at the end (plus one per CIP refusal).
+template <class Transport, class Clock, class Logger>
+uint8_t BasicITLA<Transport, Clock, Logger>::applyOperatingPoint(uint32_t channel, int16_t powerRaw, int16_t ftfRaw) {
+    if (plan.valid() && !plan.contains(channel)) {
+        lastErr = ITLA_ERR_RVE;
+        return 0xFF;
+    }
+
+    uint8_t writes = 0;
+    uint16_t chLS = channel & 0xFFFF;
+    uint16_t chMS = (channel >> 16) & 0xFFFF;
+
+    if ((int16_t)readRegister(ITLA_REG_POWER) != powerRaw) {
+        if (!writeWhenReady(ITLA_REG_POWER, (uint16_t)powerRaw)) return 0xFF;
+        writes++;
+    }
+
+    uint16_t curMS = readRegister(ITLA_REG_CHANNELH);
+    uint16_t curLS = readRegister(ITLA_REG_CHANNEL);
+    bool msDiffers = curMS != chMS;
+    bool lsDiffers = curLS != chLS;
+    unsigned long expectMs = 0;
+    if (msDiffers || lsDiffers) {
+        // Skip most of the polling this retune is known to need (3/4 of the
+        // module's measured pending time, so a faster tune is still caught early)
+        if (tuner) expectMs = tuner->pendingEstimateMs(((uint32_t)curMS << 16) | curLS, channel) * 3UL / 4;
+        // The LSW write commits the tune, so it is always written on a change
+        if (msDiffers) {
+            if (!writeWhenReady(ITLA_REG_CHANNELH, chMS)) return 0xFF;
+            writes++;
+        }
+        if (!writeWhenReady(ITLA_REG_CHANNEL, chLS)) return 0xFF;
+        writes++;
+    }
+
+    if (ftfRaw != ITLA_FTF_UNCHANGED && (int16_t)readRegister(ITLA_REG_FTF) != ftfRaw) {
+        if (!writeWhenReady(ITLA_REG_FTF, (uint16_t)ftfRaw)) return 0xFF;
+        writes++;
+    }
+
+    if (writes > 0 && !waitPending(PENDING_TIMEOUT_MS, expectMs)) return 0xFF;
+    return writes;
+}
+
+template <class Transport, class Clock, class Logger>
+FreqMHz BasicITLA<Transport, Clock, Logger>::getFrequencyLFMHz() {
+    uint16_t lf1 = readRegister(ITLA_REG_LF1); // THz
+    uint16_t lf2 = readRegister(ITLA_REG_LF2); // GHz*10
+    uint16_t lf3 = readRegister(ITLA_REG_LF3); // MHz
+    return freqFromRegs(lf1, lf2, lf3);
+}
+
+template <class Transport, class Clock, class Logger>
+double BasicITLA<Transport, Clock, Logger>::getFrequencyLF() {
+    return freqToTHz(getFrequencyLFMHz());
+}
+
+
+template <class Transport, class Clock, class Logger>
+double BasicITLA<Transport, Clock, Logger>::getTemperature() {
+    int16_t raw = (int16_t)readRegister(ITLA_REG_TEMP);
+    return (double)raw / 100.0;
+}
+
+/*String ITLA::readSerialNumber() {
+    uint8_t status;
+    uint16_t lenVal = transact(ITLA_REG_SN, false, 0, status);
+    if (status != 2) return "";
+    uint8_t strLen = lenVal & 0xFF;
+    String s = "";
+    for (int i = 0; i < (int)strLen; i += 2) {
+        uint16_t chunk = transact(ITLA_REG_EAR, false, 0, status);
+        if (status == 0) {
+            char c1 = (char)((chunk >> 8) & 0xFF);
+            char c2 = (char)(chunk & 0xFF);
+            if (c1 == 0 || i >= strLen) break;
+            s += c1;
+            if (c2 == 0 || i + 1 >= strLen) break;
+            s += c2;
+        } else break;
+    }
+    return s; */
+/*String ITLA::readAEAString(uint8_t reg) {
+    uint8_t status;
+    uint16_t lenVal = transact(reg,false,0,status);
+    if (status != 2) return "";
+    uint8_t strLen = lenVal & 0xFF;
+    String s;
+    for (int i = 0; i < strLen; i += 2) {
+        uint16_t chunk = transact(ITLA_REG_EAR,false,0,status);
+        if (status != 0) break;
+        char c1 = (chunk>>8)&0xFF;
+        char c2 = chunk&0xFF;
+        if (c1==0 || i >= strLen) break;
+        s += c1;
+        if (c2==0 || i+1>=strLen) break;
+        s += c2;
+    }
+    return s;
+}*/
+template <class Transport, class Clock, class Logger>
+String BasicITLA<Transport, Clock, Logger>::readAEAString(uint8_t reg) {
+    uint8_t st;
+    // 1) fetch length (status==2)
+    uint16_t lenVal = transact(reg, false, 0, st);
+    if (st != 2) {
+        logger.event(LOG_AEA_ERROR, reg, 0, st);
+        return "";
+    }
+    uint8_t strLen = lenVal & 0xFF;
+
+    // 2) read in 2-byte chunks
+    String s;
+    for (int i = 0; i < strLen; i += 2) {
+        uint16_t chunk = transact(ITLA_REG_EAR, false, 0, st);
+        if (st != 0) {
+            logger.event(LOG_AEA_ERROR, reg, i, st);
+            break;
+        }
+        char c1 = (chunk >> 8) & 0xFF;
+        char c2 =  chunk       & 0xFF;
+        if (c1 == '\0') break;
+        s += c1;
+        if (i + 1 >= strLen || c2 == '\0') break;
+        s += c2;
+    }
+    return s;
+}
+
+template <class Transport, class Clock, class Logger>
+uint8_t BasicITLA<Transport, Clock, Logger>::getErrorCode() {
+    uint8_t st;
+    uint8_t failed = lastSt;   // lastStatus() keeps reporting the XE, not this NOP
+    uint16_t val = transact(ITLA_REG_NOP, false, 0, st);
+    lastSt = failed;
+    return (uint8_t)(val & 0x0F);
+}
+
+template <class Transport, class Clock, class Logger>
+uint8_t BasicITLA<Transport, Clock, Logger>::pendingFlags() {
+    uint8_t st;
+    uint16_t val = transact(ITLA_REG_NOP, false, 0, st);
+    if (st != 0) return PENDING_UNKNOWN;
+    return (uint8_t)(val >> 8);
+}
+// Set verbose mode
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::setVerbose(bool on) {
+    logger.setVerbose(on);
+}
+
+template <class Transport, class Clock, class Logger>
+void BasicITLA<Transport, Clock, Logger>::yieldLink(unsigned long ms) {
+    if (!yieldFn || inYield) {
+        if (ms) clock.sleep(ms);
+        return;
+    }
+    inYield = true;
+    yieldFn(yieldCtx, ms);
+    inYield = false;
+}
+
+
+// need to confirm 
+template <class Transport, class Clock, class Logger>
+PowerCdBm BasicITLA<Transport, Clock, Logger>::getPower() {
+    return (PowerCdBm)readRegister(ITLA_REG_POWER);
+}
+
+template <class Transport, class Clock, class Logger>
+double BasicITLA<Transport, Clock, Logger>::getPower_dBm() {
+    return powerToDbm(getPower());
+}
+
+template <class Transport, class Clock, class Logger>
+uint32_t BasicITLA<Transport, Clock, Logger>::getChannel() {
+    uint16_t channelLS = readRegister(ITLA_REG_CHANNEL);       // 0x30
+    uint16_t channelMS = readRegister(ITLA_REG_CHANNELH);      // 0x65
+    return ((uint32_t)channelMS << 16) | channelLS;
+}
+
+template <class Transport, class Clock, class Logger>
+FreqMHz BasicITLA<Transport, Clock, Logger>::getFrequencyMHz() {
+    uint32_t channel = getChannel();
+    if (plan.valid()) return plan.frequency(channel);
+
+    FreqMHz first;
+    int32_t gridMHz;
+    gridAndFirst(first, gridMHz);
+    return channelFreq(first, gridMHz, channel);
+}
+
+template <class Transport, class Clock, class Logger>
+double BasicITLA<Transport, Clock, Logger>::getFrequencyTHz() {
+    return freqToTHz(getFrequencyMHz());
+}
+
+template <class Transport, class Clock, class Logger>
+bool BasicITLA<Transport, Clock, Logger>::isLaserOn() {
+    uint16_t val = readRegister(ITLA_REG_RESETA);
+    return (val & 0x08) != 0;
+}
+
+#endif // ITLA_IMPL_H
@@ -0,0 +1,32 @@
+// File: ITLA_LiveApply.cpp
+#include "ITLA_LiveApply.h"
+
+SetpointCoalescer::SetpointCoalescer(unsigned long quiet, unsigned long minInterval)
+    : quietMs(quiet), minIntervalMs(minInterval), value(0), pending(false),
+      lastChange(0), firstChange(0), lastSend(0) { }
+
+void SetpointCoalescer::update(int64_t v, unsigned long now) {
+    if (!pending) firstChange = now;
+    value = v;
+    pending = true;
+    lastChange = now;
+}
+
+bool SetpointCoalescer::due(unsigned long now) const {
+    if (!pending) return false;
+    if (now - lastSend < minIntervalMs) return false;      // rate limit
+    // Send once input settles, or periodically while it keeps moving
+    return (now - lastChange >= quietMs) || (now - firstChange >= minIntervalMs);
+}
+
+int64_t SetpointCoalescer::take(unsigned long now) {
+    pending = false;
+    lastSend = now;
+    return value;
+}
+
+void SetpointCoalescer::rejected(int64_t v, unsigned long now) {
+    lastSend = now;          // back off for minIntervalMs before retrying
+    if (pending) return;     // a newer value already replaced it
+    update(v, now);
+}
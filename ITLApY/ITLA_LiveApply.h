@@ -0,0 +1,41 @@
+// File: ITLA_LiveApply.h
+// Coalesces a stream of setpoint changes (e.g. INC/DEC auto-repeat) into a few writes.
+// Only the newest value is kept; it is released once the input has been quiet for
+// quietMs, or every minIntervalMs while the user keeps adjusting. A value the module
+// rejects (e.g. ITLA_ERR_CIP during a tune) is retried unless a newer one replaced it.
+#ifndef ITLA_LIVEAPPLY_H
+#define ITLA_LIVEAPPLY_H
+
+#include <Arduino.h>
+
+class SetpointCoalescer {
+public:
+    SetpointCoalescer(unsigned long quietMs, unsigned long minIntervalMs);
+
+    // Record the newest setpoint; any unsent older value is dropped.
+    // Values are the integer quantities from ITLA_Units.h (MHz, 0.01 dBm).
+    void update(int64_t value, unsigned long now);
+
+    // True when a value is waiting and the quiet/rate-limit rules allow sending it.
+    bool due(unsigned long now) const;
+
+    // Hand out the value to send and mark it in flight.
+    int64_t take(unsigned long now);
+
+    // The module rejected the value from take(); resend it later unless superseded.
+    void rejected(int64_t value, unsigned long now);
+
+    bool hasPending() const { return pending; }
+    void cancel() { pending = false; }
+
+private:
+    unsigned long quietMs;
+    unsigned long minIntervalMs;
+    int64_t value;
+    bool pending;
+    unsigned long lastChange;   // time of newest update()
+    unsigned long firstChange;  // first update() since the last send
+    unsigned long lastSend;
+};
+
+#endif // ITLA_LIVEAPPLY_H
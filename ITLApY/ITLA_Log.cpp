@@ -0,0 +1,61 @@
+// File: ITLA_Log.cpp
+#include "ITLA_Log.h"
+
+ITLALog itlaLog;
+
+ITLALog::ITLALog() {
+    clear();
+}
+
+void ITLALog::clear() {
+    head = tail = 0;
+    lost = lostTotal = 0;
+}
+
+void ITLALog::log(uint8_t event, uint8_t a, uint16_t b, uint32_t c) {
+    if ((uint16_t)(head - tail) == LOG_RING_RECORDS) {
+        tail++;   // drop the oldest
+        lost++;
+        lostTotal++;
+    }
+    LogRecord &r = ring[head & (LOG_RING_RECORDS - 1)];
+    r.timeUs = micros();
+    r.event = event;
+    r.a = a;
+    r.b = b;
+    r.c = c;
+    head++;
+}
+
+static void printHex(Print &out, const uint8_t *p, uint8_t n) {
+    static const char digits[] = "0123456789abcdef";
+    char buf[2 * sizeof(LogRecord) + 1];
+    for (uint8_t i = 0; i < n; i++) {
+        buf[2 * i] = digits[p[i] >> 4];
+        buf[2 * i + 1] = digits[p[i] & 0x0F];
+    }
+    buf[2 * n] = '\0';
+    out.print(buf);
+}
+
+uint8_t ITLALog::drain(Print &out, uint8_t maxRecords) {
+    if (head == tail && lost == 0) return 0;
+
+    out.print(LOG_LINE_PREFIX);
+    uint8_t n = 0;
+    if (lost) {
+        // Stamped like the oldest survivor so the decoded timeline stays ordered
+        uint32_t t = head != tail ? ring[tail & (LOG_RING_RECORDS - 1)].timeUs : (uint32_t)micros();
+        LogRecord r = { t, LOG_DROPPED, 0, 0, lost };
+        printHex(out, (const uint8_t *)&r, sizeof(r));
+        lost = 0;
+        n++;
+    }
+    while (n < maxRecords && head != tail) {
+        printHex(out, (const uint8_t *)&ring[tail & (LOG_RING_RECORDS - 1)], sizeof(LogRecord));
+        tail++;
+        n++;
+    }
+    out.println();
+    return n;
+}
@@ -0,0 +1,58 @@
+// File: ITLA_Log.h
+// Deferred binary log for the driver's I/O path. A log call copies a 12-byte
+// record (event ID, micros(), three integers) into a RAM ring and returns;
+// nothing is formatted or printed while a frame is in flight. drain(), called
+// from idle time in loop(), writes pending records to the host as hex lines
+// starting with '~' (the GUI ignores lines that are not JSON), and
+// host/itla_logdecode turns them back into text using ITLA_LogEvents.def.
+// When the ring is full the oldest records are overwritten and counted.
+// Not for use from interrupt handlers.
+#ifndef ITLA_LOG_H
+#define ITLA_LOG_H
+
+#include <Arduino.h>
+
+#define LOG_RING_RECORDS 128   // power of two
+#define LOG_LINE_PREFIX  '~'
+
+enum ITLALogEvent {
+#define ITLA_LOG_EVENT(name, format) LOG_##name,
+#include "ITLA_LogEvents.def"
+#undef ITLA_LOG_EVENT
+    LOG_EVENT_COUNT
+};
+
+// Wire and ring layout, little-endian
+struct LogRecord {
+    uint32_t timeUs;   // micros() when logged
+    uint8_t event;     // ITLALogEvent
+    uint8_t a;
+    uint16_t b;
+    uint32_t c;
+};
+
+class ITLALog {
+public:
+    static const uint8_t DRAIN_RECORDS = 4;   // per drain() call, keeps loop() passes short
+
+    ITLALog();
+
+    void log(uint8_t event, uint8_t a = 0, uint16_t b = 0, uint32_t c = 0);
+
+    // Write up to maxRecords pending records as one line; returns how many
+    uint8_t drain(Print &out, uint8_t maxRecords = DRAIN_RECORDS);
+
+    uint16_t pending() const { return (uint16_t)(head - tail); }
+    uint32_t overwritten() const { return lostTotal; }
+    void clear();
+
+private:
+    LogRecord ring[LOG_RING_RECORDS];
+    uint16_t head, tail;    // free-running, masked on access
+    uint32_t lost;          // not yet reported with a DROPPED record
+    uint32_t lostTotal;
+};
+
+extern ITLALog itlaLog;
+
+#endif // ITLA_LOG_H
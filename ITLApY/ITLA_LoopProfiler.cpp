@@ -0,0 +1,172 @@
+// File: ITLA_LoopProfiler.cpp
+#include "ITLA_LoopProfiler.h"
+
+LoopProfiler loopProfiler;
+
+LoopProfiler::LoopProfiler() : used(0), tpu(1), stallTicks(DEFAULT_STALL_US), open(0) {
+    reset();
+}
+
+void LoopProfiler::begin(uint32_t stallUs) {
+#if defined(ARDUINO_ARCH_SAM)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    tpu = SystemCoreClock / 1000000;
+#else
+    tpu = 1;
+#endif
+    stallTicks = stallUs * tpu;
+    reset();
+}
+
+uint8_t LoopProfiler::section(const char *name) {
+    if (used == LOOP_SECTIONS) return LOOP_NONE;
+    names[used] = name;
+    return used++;
+}
+
+void LoopProfiler::reset() {
+    memset(sec, 0, sizeof(sec));
+    for (uint8_t i = 0; i <= LOOP_SECTIONS; i++) sec[i].minTicks = 0xFFFFFFFF;
+    memset(passSelf, 0, sizeof(passSelf));
+    memset(worstSelf, 0, sizeof(worstSelf));
+    worstTicks = 0;
+    stallsOther = 0;
+    passStart = now();
+}
+
+void LoopProfiler::addTo(LoopStats &s, uint32_t ticks, uint32_t tpu) {
+    s.count++;
+    s.sumTicks += ticks;
+    if (ticks < s.minTicks) s.minTicks = ticks;
+    if (ticks > s.maxTicks) s.maxTicks = ticks;
+    // Bucket b >= 1 holds [2^(b-1), 2^b) us
+    uint32_t us = ticks / tpu;
+    uint8_t b = us ? (uint8_t)(32 - __builtin_clz(us)) : 0;
+    s.hist[b < LOOP_BUCKETS ? b : LOOP_BUCKETS - 1]++;
+}
+
+void LoopProfiler::add(uint8_t id, uint32_t inclusive, uint32_t self) {
+    if (id >= used) return;
+    addTo(sec[id], inclusive, tpu);
+    passSelf[id] += self;
+}
+
+void LoopProfiler::loopStart() {
+    passStart = now();
+}
+
+void LoopProfiler::loopEnd() {
+    uint32_t t = now() - passStart;
+    addTo(sec[LOOP_SECTIONS], t, tpu);
+
+    if (t > worstTicks) {
+        worstTicks = t;
+        memcpy(worstSelf, passSelf, sizeof(worstSelf));
+    }
+    if (t >= stallTicks) {
+        sec[LOOP_SECTIONS].stalls++;
+        // Charge the stall to whoever took most of it, probes or the rest
+        uint8_t top = 0;
+        uint32_t probed = 0;
+        for (uint8_t i = 0; i < used; i++) {
+            probed += passSelf[i];
+            if (passSelf[i] > passSelf[top]) top = i;
+        }
+        uint32_t other = t > probed ? t - probed : 0;
+        if (used == 0 || other > passSelf[top]) stallsOther++;
+        else sec[top].stalls++;
+    }
+    memset(passSelf, 0, sizeof(passSelf));
+}
+
+// ---------- Report ----------
+
+static void printPadded(Print &out, uint32_t v, uint8_t width) {
+    char buf[12];
+    uint8_t n = 0;
+    do {
+        buf[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (width-- > n) out.print(' ');
+    while (n) out.print(buf[--n]);
+}
+
+static void printName(Print &out, const char *name, uint8_t width) {
+    uint8_t n = 0;
+    for (; name[n] && n < width; n++) out.print(name[n]);
+    while (n++ < width) out.print(' ');
+}
+
+// Upper bound in us of the bucket holding the 99th percentile; the last
+// bucket is open, the max stands in for its bound
+static uint32_t p99Us(const LoopStats &s, uint32_t tpu) {
+    uint32_t need = s.count - s.count / 100, seen = 0;
+    for (uint8_t b = 0; b + 1 < LOOP_BUCKETS; b++) {
+        seen += s.hist[b];
+        if (seen >= need) return 1UL << b;
+    }
+    return s.maxTicks / tpu + 1;
+}
+
+void LoopProfiler::printStats(Print &out, const char *name, const LoopStats &s) const {
+    printName(out, name, 10);
+    printPadded(out, s.count, 9);
+    if (s.count) {
+        printPadded(out, s.minTicks / tpu, 9);
+        printPadded(out, (uint32_t)(s.sumTicks / s.count / tpu), 9);
+        printPadded(out, s.maxTicks / tpu, 9);
+        printPadded(out, p99Us(s, tpu), 9);
+    } else {
+        out.print("        -        -        -        -");
+    }
+    printPadded(out, s.stalls, 8);
+    out.println();
+}
+
+void LoopProfiler::report(Print &out) const {
+    const LoopStats &pass = sec[LOOP_SECTIONS];
+    out.print("Loop profile (us), stall limit ");
+    out.print(stallTicks / tpu);
+    out.println(" us");
+    out.println("section       count      min      avg      max    p99 <  stalls");
+    printStats(out, "loop", pass);
+    for (uint8_t i = 0; i < used; i++) printStats(out, names[i], sec[i]);
+    printName(out, "(other)", 55);
+    printPadded(out, stallsOther, 8);
+    out.println();
+
+    // Histogram columns: bucket upper bounds in us, last one open
+    out.print("histogram ");
+    for (uint8_t b = 0; b < LOOP_BUCKETS; b++) {
+        out.print(b + 1 < LOOP_BUCKETS ? " <" : " >=");
+        out.print(1UL << (b + 1 < LOOP_BUCKETS ? b : b - 1));
+    }
+    out.println();
+    for (uint8_t i = 0; i <= used; i++) {
+        const LoopStats &s = i < used ? sec[i] : pass;
+        printName(out, i < used ? names[i] : "loop", 10);
+        for (uint8_t b = 0; b < LOOP_BUCKETS; b++) {
+            out.print(' ');
+            out.print(s.hist[b]);
+        }
+        out.println();
+    }
+
+    out.print("slowest pass ");
+    out.print(worstTicks / tpu);
+    out.print(" us:");
+    uint32_t probed = 0;
+    for (uint8_t i = 0; i < used; i++) {
+        probed += worstSelf[i];
+        if (!worstSelf[i]) continue;
+        out.print(' ');
+        out.print(names[i]);
+        out.print(' ');
+        out.print(worstSelf[i] / tpu);
+    }
+    out.print(" other ");
+    out.println(worstTicks > probed ? (worstTicks - probed) / tpu : 0);
+}
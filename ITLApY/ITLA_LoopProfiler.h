@@ -0,0 +1,119 @@
+// File: ITLA_LoopProfiler.h
+// Timing of loop() and the sections in it. A sketch names its sections once
+// in setup(), brackets each pass with loopStart()/loopEnd() and puts a
+// LOOP_PROBE(id) at the top of every block or function to be timed; report()
+// prints, on request:
+//   per section  count, min / avg / max and p99 (from the histogram) in us
+//   histogram    passes per power-of-two bucket of us, the jitter at a glance
+//   attribution  passes over the stall limit, each charged to the section
+//                that took the largest share of it (self time, nested probes
+//                not counted twice), and the breakdown of the slowest pass
+// Time comes from the DWT cycle counter on the Due (one load per reading,
+// 12 ns resolution) and micros() elsewhere. A probe costs two readings and
+// a few additions, small enough to leave in production builds; define
+// ITLA_LOOP_PROFILE as 0 (e.g. in the board's build flags) to compile the
+// probes out altogether.
+// Sections' stats use inclusive time: a probe in displayCurrentMenu() called
+// from handleButtons() counts for both. Not for use from interrupt handlers.
+#ifndef ITLA_LOOP_PROFILER_H
+#define ITLA_LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef ITLA_LOOP_PROFILE
+#define ITLA_LOOP_PROFILE 1
+#endif
+
+#define LOOP_SECTIONS 8        // besides the whole pass
+#define LOOP_BUCKETS  16       // <1 us, 1-2 us, 2-4 us ... >= 16.4 ms
+#define LOOP_NONE     0xFF     // section() when all are taken
+
+struct LoopStats {
+    uint32_t count;
+    uint32_t minTicks, maxTicks;
+    uint64_t sumTicks;
+    uint32_t hist[LOOP_BUCKETS];
+    uint32_t stalls;           // passes over the limit charged to this section
+};
+
+class LoopProbe;
+
+class LoopProfiler {
+public:
+    static const uint32_t DEFAULT_STALL_US = 10000;
+
+    LoopProfiler();
+
+    // Starts the cycle counter where there is one
+    void begin(uint32_t stallUs = DEFAULT_STALL_US);
+    // Registers a section; name must stay valid (a literal)
+    uint8_t section(const char *name);
+
+    void loopStart();
+    void loopEnd();
+
+    void report(Print &out) const;
+    void reset();
+
+    uint32_t now() const {
+#if defined(ARDUINO_ARCH_SAM)
+        return DWT->CYCCNT;
+#else
+        return micros();
+#endif
+    }
+    uint32_t ticksPerUs() const { return tpu; }
+    const LoopStats &stats(uint8_t id) const { return sec[id]; }   // LOOP_SECTIONS: the whole pass
+
+private:
+    friend class LoopProbe;
+
+    LoopStats sec[LOOP_SECTIONS + 1];
+    const char *names[LOOP_SECTIONS];
+    uint8_t used;
+    uint32_t tpu;
+    uint32_t stallTicks;
+    uint32_t passStart;
+    uint32_t passSelf[LOOP_SECTIONS];     // self time per section in this pass
+    uint32_t worstTicks;
+    uint32_t worstSelf[LOOP_SECTIONS];
+    uint32_t stallsOther;                 // stalls mostly outside any probe
+    LoopProbe *open;                      // innermost running probe
+
+    void add(uint8_t id, uint32_t inclusive, uint32_t self);
+    static void addTo(LoopStats &s, uint32_t ticks, uint32_t tpu);
+    void printStats(Print &out, const char *name, const LoopStats &s) const;
+};
+
+extern LoopProfiler loopProfiler;
+
+// Times the enclosing scope as section id
+class LoopProbe {
+public:
+    LoopProbe(LoopProfiler &p, uint8_t id) : prof(p), id(id), parent(p.open), childTicks(0), t0(p.now()) {
+        p.open = this;
+    }
+    ~LoopProbe() {
+        uint32_t t = prof.now() - t0;
+        prof.open = parent;
+        if (parent) parent->childTicks += t;
+        prof.add(id, t, t - childTicks);
+    }
+
+private:
+    LoopProfiler &prof;
+    uint8_t id;
+    LoopProbe *parent;
+    uint32_t childTicks;
+    uint32_t t0;
+};
+
+#if ITLA_LOOP_PROFILE
+#define LOOP_PROBE_NAME2(line) loopProbe_##line
+#define LOOP_PROBE_NAME(line) LOOP_PROBE_NAME2(line)
+#define LOOP_PROBE(id) LoopProbe LOOP_PROBE_NAME(__LINE__)(loopProfiler, (id))
+#else
+#define LOOP_PROBE(id) ((void)0)
+#endif
+
+#endif // ITLA_LOOP_PROFILER_H
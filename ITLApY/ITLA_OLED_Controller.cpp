@@ -5,6 +5,15 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "ITLA.h"
+#include "ITLA_Buttons.h"
+#include "ITLA_LiveApply.h"
+#include "ITLA_ConfigStore.h"
+#include "ITLA_Presets.h"
+#include "ITLA_Profile.h"
+#include "ITLA_TuneProfiler.h"
+#include "ITLA_Log.h"
+#include "ITLA_LoopProfiler.h"
+#include "ITLA_BootTrace.h"
 
 // OLED Setup
 #define SCREEN_WIDTH 128
@@ -22,7 +31,8 @@ Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET); // cre
 #define BUTTON_OK_PIN 6
 
 // ITLA instance
-ITLA itla(Serial1);
+ITLASerial itlaPort(Serial1);
+ITLA itla(itlaPort);
 
 // Menu system enums
 enum MenuState {
@@ -33,7 +43,8 @@ enum MenuState {
   FREQUENCY_SETTINGS,
   TEMPERATURE_MONITOR,
   STATUS_MONITOR,
-  ADVANCED_SETTINGS
+  ADVANCED_SETTINGS,
+  PRESET_MENU
 };
 
 enum LaserControlState {
@@ -47,13 +58,12 @@ MenuState currentMenu = MAIN_MENU;
 int menuIndex = 0;
 bool deviceConnected = false;
 LaserControlState laserState = LASER_UNKNOWN;
-double currentPower = 0.0;
-double currentFreq = 0.0;
+PowerCdBm currentPower = 0;
+FreqMHz currentFreq = 0;
 double currentTemp = 0.0;
 
-// Button debouncing
-unsigned long lastButtonPress = 0;
-const unsigned long BUTTON_DEBOUNCE = 200;
+// Set by button handlers; the menu is redrawn once after the event queue is drained
+bool menuDirty = false;
 
 // Menu items for main menu
 const char* mainMenuItems[] = {
@@ -63,64 +73,175 @@ const char* mainMenuItems[] = {
   "Freq Settings",
   "Temperature",
   "Status Monitor",
-  "Advanced"
+  "Advanced",
+  "Presets"
 };
 const int mainMenuCount = sizeof(mainMenuItems) / sizeof(mainMenuItems[0]);
+const int MAIN_MENU_VISIBLE = 5;   // rows left under the header
 
-// Power settings
-double powerSetpoint = 0.0;
-const double POWER_MIN = -20.0;
-const double POWER_MAX = 20.0;
-const double POWER_STEP = 0.1;
+// Preset menu selection
+int presetIndex = 0;
+
+// Power settings (0.01 dBm, the POWER register encoding)
+PowerCdBm powerSetpoint = 0;
+const PowerCdBm POWER_MIN = -2000;
+const PowerCdBm POWER_MAX = 2000;
+const PowerCdBm POWER_STEP = 10;          // 0.1 dB
+const PowerCdBm POWER_COARSE_STEP = 100;  // 1 dB, used while INC/DEC is held
 
 // Frequency settings
-double freqSetpoint = 193.1; // THz
-const double FREQ_MIN = 191.0;
-const double FREQ_MAX = 196.0;
-const double FREQ_STEP = 0.01;
+// Integer MHz so hundreds of steps land exactly on the grid (no drift).
+// With the module's channel plan the menu steps whole channels instead;
+// these are the fallback steps and limits when no profile is available.
+FreqMHz freqSetpoint = 193100000;          // 193.1 THz
+const FreqMHz FREQ_MIN = 191000000;
+const FreqMHz FREQ_MAX = 196000000;
+const FreqMHz FREQ_STEP = 10000;           // 0.01 THz
+const FreqMHz FREQ_CHANNEL_STEP = 50000;   // one 50 GHz ITU channel
+const FreqMHz FREQ_COARSE_STEP = 1000000;  // 1 THz
+
+// Live apply: send INC/DEC changes without pressing OK, coalesced so the
+// module only sees the latest value (retunes are slow, so frequency waits longer)
+bool liveApply = false;
+SetpointCoalescer powerLive(150, 400);    // quiet ms, min ms between writes
+SetpointCoalescer freqLive(300, 1000);
+
+// loop() sections; 'P' over USB prints the profile, 'R' clears it
+uint8_t secButtons, secLive, secConfig, secLink, secUpdate, secDisplay, secDrain;
+
+// Longest wait for a host to open the port; a headless rack boots without one
+#define SERIAL_WAIT_MS 250
+
+// Display and store init need no module: they run during the ITLA probe.
+// 'B' over USB prints the boot timeline.
+BootSteps bootSteps;
+bool displayOk = false;
+
+void initDisplay() {
+  displayOk = display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  if (!displayOk) return;
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  display.setCursor(0, 0);
+  display.println(F("Initializing ITLA..."));
+  display.display();
+}
+
+void initStore() {
+  // Stored presets
+  configStore.begin();
+}
+
+// Handlers and screens, defined below (a plain .cpp gets no generated
+// prototypes; this also lets the sketch build on a host, see host/itla_oledbench.cpp)
+void handleButtons();
+void queueLiveSetpoint();
+void serviceLiveApply();
+void handleUpButton();
+void handleDownButton();
+void handleIncButton(uint8_t step);
+void handleDecButton(uint8_t step);
+void handleOkButton();
+void recallPreset(uint8_t n);
+void toggleLaser();
+void updateCurrentValues();
+void displayCurrentMenu();
+void displayMainMenu();
+void displayDeviceInfo();
+void displayLaserControl();
+void displayPowerSettings();
+void displayFrequencySettings();
+void displayTemperatureMonitor();
+void displayStatusMonitor();
+void displayAdvancedSettings();
+void displayPresetMenu();
+void displayConfirmation(const char* message);
 
 void setup() {
+  uint8_t phase = bootTrace.start("serial");
   Serial.begin(115200);
-  while (!Serial);
+  while (!Serial && millis() < SERIAL_WAIT_MS);
+  bootTrace.end(phase);
   
   Serial.println("ITLA OLED Controller Starting...");
   
-  // Initialize buttons
-  pinMode(BUTTON_UP_PIN, INPUT_PULLUP);
-  pinMode(BUTTON_DOWN_PIN, INPUT_PULLUP);
-  pinMode(BUTTON_INC_PIN, INPUT_PULLUP);
-  pinMode(BUTTON_DEC_PIN, INPUT_PULLUP);
-  pinMode(BUTTON_OK_PIN, INPUT_PULLUP);
+  // Initialize buttons (interrupt-driven, INC/DEC auto-repeat when held)
+  const uint8_t buttonPins[BTN_COUNT] = {
+    BUTTON_UP_PIN, BUTTON_DOWN_PIN, BUTTON_INC_PIN, BUTTON_DEC_PIN, BUTTON_OK_PIN
+  };
+  buttons.begin(buttonPins, (1 << BTN_INC) | (1 << BTN_DEC));
   
-  // Initialize OLED
-  if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
+  // Initialize ITLA with verbose output; OLED and store come up in its settle waits
+  bootSteps.add("oled init", initDisplay);
+  bootSteps.add("store load", initStore);
+  itla.setYieldHook(BootSteps::yieldHook, &bootSteps);
+  phase = bootTrace.start("itla probe");
+  deviceConnected = itla.begin(true);
+  bootTrace.end(phase);
+  itla.setYieldHook(0, 0);
+  bootSteps.finish();
+
+  if (!displayOk) {
     Serial.println(F("SSD1306 allocation failed"));
     while (true);
   }
   
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-  display.setCursor(0, 0);
-  display.println(F("Initializing ITLA..."));
-  display.display();
-  
-  // Initialize ITLA with verbose output
-  deviceConnected = itla.begin(true);
-  
+  phase = bootTrace.start("attach");
   if (deviceConnected) {
     Serial.println("ITLA connected successfully!");
+    profiles.attach(itla);
+    tuneProfiler.attach(itla);
+    freqSetpoint = itla.channelPlan().snap(freqSetpoint);
     // Read initial values
     updateCurrentValues();
   } else {
     Serial.println("ITLA connection failed!");
   }
+  bootTrace.end(phase);
   
+  phase = bootTrace.start("first frame");
   displayCurrentMenu();
+  bootTrace.end(phase);
+
+  secButtons = loopProfiler.section("buttons");
+  secLive = loopProfiler.section("liveapply");
+  secConfig = loopProfiler.section("config");
+  secLink = loopProfiler.section("link");
+  secUpdate = loopProfiler.section("update");
+  secDisplay = loopProfiler.section("display");
+  secDrain = loopProfiler.section("drain");
+  loopProfiler.begin();
+
+  bootTrace.ready();
+  bootTrace.report(Serial);
 }
 
 void loop() {
+  loopProfiler.loopStart();
+
   handleButtons();
+  serviceLiveApply();
+  {
+    LOOP_PROBE(secConfig);
+    configStore.poll(millis());
+  }
+
+  // Track link health so the UI shows a pulled cable within a few frames
+  {
+    LOOP_PROBE(secLink);
+    itla.serviceLink();
+  }
+  bool connected = itla.linkState() != LINK_LOST;
+  if (connected != deviceConnected) {
+    deviceConnected = connected;
+    if (connected) {
+      profiles.attach(itla);
+      tuneProfiler.attach(itla);
+      freqSetpoint = itla.channelPlan().snap(freqSetpoint);
+    }
+    menuDirty = true;
+  }
   
   // Update values periodically when monitoring
   static unsigned long lastUpdate = 0;
@@ -131,30 +252,76 @@ void loop() {
     }
     lastUpdate = millis();
   }
+
+  while (Serial.available()) {
+    int c = Serial.read();
+    if (c == 'P') loopProfiler.report(Serial);
+    else if (c == 'R') loopProfiler.reset();
+    else if (c == 'B') bootTrace.report(Serial);
+  }
+
+  // Driver trace/error records go out over USB once the work above is done
+  {
+    LOOP_PROBE(secDrain);
+    itlaLog.drain(Serial);
+  }
+
+  loopProfiler.loopEnd();
 }
 
 void handleButtons() {
-  if (millis() - lastButtonPress < BUTTON_DEBOUNCE) return;
-  
-  if (digitalRead(BUTTON_UP_PIN) == LOW) {
-    handleUpButton();
-    lastButtonPress = millis();
+  LOOP_PROBE(secButtons);
+  ButtonEvent ev;
+  while (buttons.next(ev)) {
+    switch (ev.button) {
+      case BTN_UP:   handleUpButton(); break;
+      case BTN_DOWN: handleDownButton(); break;
+      case BTN_INC:  handleIncButton(ev.step); queueLiveSetpoint(); break;
+      case BTN_DEC:  handleDecButton(ev.step); queueLiveSetpoint(); break;
+      case BTN_OK:   handleOkButton(); break;
+    }
   }
-  else if (digitalRead(BUTTON_DOWN_PIN) == LOW) {
-    handleDownButton();
-    lastButtonPress = millis();
+
+  if (menuDirty) {
+    menuDirty = false;
+    displayCurrentMenu();
   }
-  else if (digitalRead(BUTTON_INC_PIN) == LOW) {
-    handleIncButton();
-    lastButtonPress = millis();
+}
+
+void queueLiveSetpoint() {
+  if (!liveApply) return;
+  if (currentMenu == POWER_SETTINGS) {
+    powerLive.update(powerSetpoint, millis());
+  } else if (currentMenu == FREQUENCY_SETTINGS) {
+    freqLive.update(freqSetpoint, millis());
   }
-  else if (digitalRead(BUTTON_DEC_PIN) == LOW) {
-    handleDecButton();
-    lastButtonPress = millis();
+}
+
+// Send whichever live setpoint is due. A write refused with CIP (previous
+// tune still pending) is retried later unless a newer value replaced it.
+void serviceLiveApply() {
+  LOOP_PROBE(secLive);
+  if (!deviceConnected) return;
+  unsigned long now = millis();
+
+  if (powerLive.due(now)) {
+    PowerCdBm p = (PowerCdBm)powerLive.take(now);
+    if (itla.setPower(p)) {
+      currentPower = p;
+      if (currentMenu == POWER_SETTINGS) menuDirty = true;
+    } else if (itla.lastErrorCode() == ITLA_ERR_CIP) {
+      powerLive.rejected(p, now);
+    }
   }
-  else if (digitalRead(BUTTON_OK_PIN) == LOW) {
-    handleOkButton();
-    lastButtonPress = millis();
+
+  if (freqLive.due(now)) {
+    FreqMHz f = freqLive.take(now);
+    if (itla.setFrequencyMHz(f)) {
+      currentFreq = f;
+      if (currentMenu == FREQUENCY_SETTINGS) menuDirty = true;
+    } else if (itla.lastErrorCode() == ITLA_ERR_CIP) {
+      freqLive.rejected(f, now);
+    }
   }
 }
 
@@ -162,13 +329,13 @@ void handleUpButton() {
   switch (currentMenu) {
     case MAIN_MENU:
       menuIndex = (menuIndex - 1 + mainMenuCount) % mainMenuCount;
-      displayCurrentMenu();
+      menuDirty = true;
       break;
     default:
       // Go back to main menu
       currentMenu = MAIN_MENU;
       menuIndex = 0;
-      displayCurrentMenu();
+      menuDirty = true;
       break;
   }
 }
@@ -177,7 +344,11 @@ void handleDownButton() {
   switch (currentMenu) {
     case MAIN_MENU:
       menuIndex = (menuIndex + 1) % mainMenuCount;
-      displayCurrentMenu();
+      menuDirty = true;
+      break;
+    case PRESET_MENU:
+      presetIndex = (presetIndex + 1) % PRESET_COUNT;
+      menuDirty = true;
       break;
     default:
       // Navigation within submenus can be added here
@@ -185,36 +356,64 @@ void handleDownButton() {
   }
 }
 
-void handleIncButton() {
+PowerCdBm powerStepFor(uint8_t step) {
+  return step == STEP_FINE ? POWER_STEP : POWER_COARSE_STEP;
+}
+
+FreqMHz freqStepFor(uint8_t step) {
+  switch (step) {
+    case STEP_CHANNEL: return FREQ_CHANNEL_STEP;
+    case STEP_COARSE:  return FREQ_COARSE_STEP;
+    default:           return FREQ_STEP;
+  }
+}
+
+// Move the frequency setpoint one step up (dir 1) or down (dir -1). With a
+// channel plan it moves whole channels (fine: 1, then 50 GHz and 1 THz worth)
+// and stays inside LFL..LFH, so every setpoint is one the module accepts.
+void stepFrequency(uint8_t step, int8_t dir) {
+  const ChannelPlan &plan = itla.channelPlan();
+  FreqMHz f;
+  if (plan.valid()) {
+    int32_t n = step == STEP_FINE ? 1 : plan.channelsFor((int32_t)freqStepFor(step));
+    f = plan.frequency(plan.step(plan.nearest(freqSetpoint), dir * n));
+  } else {
+    f = freqSetpoint + dir * freqStepFor(step);
+    if (f > FREQ_MAX) f = FREQ_MAX;
+    if (f < FREQ_MIN) f = FREQ_MIN;
+  }
+  if (f != freqSetpoint) {
+    freqSetpoint = f;
+    menuDirty = true;
+  }
+}
+
+void handleIncButton(uint8_t step) {
   switch (currentMenu) {
     case POWER_SETTINGS:
       if (powerSetpoint < POWER_MAX) {
-        powerSetpoint += POWER_STEP;
-        displayCurrentMenu();
+        powerSetpoint += powerStepFor(step);
+        if (powerSetpoint > POWER_MAX) powerSetpoint = POWER_MAX;
+        menuDirty = true;
       }
       break;
     case FREQUENCY_SETTINGS:
-      if (freqSetpoint < FREQ_MAX) {
-        freqSetpoint += FREQ_STEP;
-        displayCurrentMenu();
-      }
+      stepFrequency(step, 1);
       break;
   }
 }
 
-void handleDecButton() {
+void handleDecButton(uint8_t step) {
   switch (currentMenu) {
     case POWER_SETTINGS:
       if (powerSetpoint > POWER_MIN) {
-        powerSetpoint -= POWER_STEP;
-        displayCurrentMenu();
+        powerSetpoint -= powerStepFor(step);
+        if (powerSetpoint < POWER_MIN) powerSetpoint = POWER_MIN;
+        menuDirty = true;
       }
       break;
     case FREQUENCY_SETTINGS:
-      if (freqSetpoint > FREQ_MIN) {
-        freqSetpoint -= FREQ_STEP;
-        displayCurrentMenu();
-      }
+      stepFrequency(step, -1);
       break;
   }
 }
@@ -231,8 +430,9 @@ void handleOkButton() {
         case 4: currentMenu = TEMPERATURE_MONITOR; break;
         case 5: currentMenu = STATUS_MONITOR; break;
         case 6: currentMenu = ADVANCED_SETTINGS; break;
+        case 7: currentMenu = PRESET_MENU; break;
       }
-      displayCurrentMenu();
+      menuDirty = true;
       break;
       
     case LASER_CONTROL:
@@ -241,22 +441,60 @@ void handleOkButton() {
       
     case POWER_SETTINGS:
       if (deviceConnected) {
-        itla.setPower_dBm(powerSetpoint);
+        powerLive.cancel();
+        itla.setPower(powerSetpoint);
         displayConfirmation("Power Set!");
         updateCurrentValues();
+        menuDirty = true;
       }
       break;
       
     case FREQUENCY_SETTINGS:
       if (deviceConnected) {
-        itla.setFrequencyTHz(freqSetpoint);
+        freqLive.cancel();
+        itla.setFrequencyMHz(freqSetpoint);
         displayConfirmation("Frequency Set!");
         updateCurrentValues();
+        menuDirty = true;
+      }
+      break;
+
+    case PRESET_MENU:
+      if (deviceConnected) {
+        recallPreset(presetIndex);
+        menuDirty = true;
+      }
+      break;
+
+    case ADVANCED_SETTINGS:
+      liveApply = !liveApply;
+      if (!liveApply) {
+        powerLive.cancel();
+        freqLive.cancel();
       }
+      menuDirty = true;
       break;
   }
 }
 
+void recallPreset(uint8_t n) {
+  Preset p;
+  if (!presets.get(n, p)) {
+    displayConfirmation("Empty!");
+    return;
+  }
+  uint8_t writes = presets.recall(itla, n);
+  if (writes == 0xFF) {
+    displayConfirmation("Failed!");
+    return;
+  }
+  powerSetpoint = p.powerRaw;
+  freqSetpoint = p.freq;
+  currentPower = powerSetpoint;
+  currentFreq = freqSetpoint;
+  displayConfirmation("Recalled!");
+}
+
 void toggleLaser() {
   if (!deviceConnected) return;
   
@@ -277,6 +515,7 @@ void toggleLaser() {
 }
 
 void updateCurrentValues() {
+  LOOP_PROBE(secUpdate);
   if (!deviceConnected) return;
   
   currentTemp = itla.getTemperature();
@@ -284,6 +523,7 @@ void updateCurrentValues() {
 }
 
 void displayCurrentMenu() {
+  LOOP_PROBE(secDisplay);
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
@@ -313,6 +553,9 @@ void displayCurrentMenu() {
     case ADVANCED_SETTINGS:
       displayAdvancedSettings();
       break;
+    case PRESET_MENU:
+      displayPresetMenu();
+      break;
   }
   
   display.display();
@@ -325,7 +568,10 @@ void displayMainMenu() {
   display.println(deviceConnected ? F("Status: Connected") : F("Status: Disconnected"));
   display.println();
   
-  for (int i = 0; i < mainMenuCount; i++) {
+  // Scroll so the selected item stays on screen
+  int first = menuIndex - MAIN_MENU_VISIBLE + 1;
+  if (first < 0) first = 0;
+  for (int i = first; i < mainMenuCount && i < first + MAIN_MENU_VISIBLE; i++) {
     if (i == menuIndex) {
       display.setTextColor(SSD1306_BLACK, SSD1306_WHITE);
     } else {
@@ -399,16 +645,16 @@ void displayPowerSettings() {
   display.println(F("--------------"));
   
   display.print(F("Current: "));
-  display.print(currentPower, 1);
+  display.print(powerToDbm(currentPower), 1);
   display.println(F(" dBm"));
   
   display.print(F("Setpoint: "));
-  display.print(powerSetpoint, 1);
+  display.print(powerToDbm(powerSetpoint), 1);
   display.println(F(" dBm"));
   
   display.println();
   display.println(F("INC/DEC: Adjust"));
-  display.println(F("OK: Set Power"));
+  display.println(liveApply ? F("Live apply active") : F("OK: Set Power"));
   display.println(F("UP: Back"));
 }
 
@@ -418,16 +664,24 @@ void displayFrequencySettings() {
   display.println(F("------------------"));
   
   display.print(F("Current: "));
-  display.print(currentFreq, 2);
+  display.print(freqToTHz(currentFreq), 2);
   display.println(F(" THz"));
   
   display.print(F("Setpoint: "));
-  display.print(freqSetpoint, 2);
+  display.print(freqToTHz(freqSetpoint), 2);
   display.println(F(" THz"));
   
-  display.println();
+  const ChannelPlan &plan = itla.channelPlan();
+  if (plan.valid()) {
+    display.print(F("Channel: "));
+    display.print((unsigned long)plan.nearest(freqSetpoint));
+    display.print(F(" of "));
+    display.println((unsigned long)plan.lastChannel());
+  } else {
+    display.println();
+  }
   display.println(F("INC/DEC: Adjust"));
-  display.println(F("OK: Set Frequency"));
+  display.println(liveApply ? F("Live apply active") : F("OK: Set Frequency"));
   display.println(F("UP: Back"));
 }
 
@@ -490,11 +744,39 @@ void displayAdvancedSettings() {
   display.setCursor(0, 0);
   display.println(F("Advanced Settings"));
   display.println(F("-----------------"));
-  display.println(F("Feature coming soon"));
+  display.print(F("Live apply: "));
+  display.println(liveApply ? F("ON") : F("OFF"));
   display.println();
+  display.println(F("OK: Toggle live apply"));
   display.println(F("UP: Back to menu"));
 }
 
+void displayPresetMenu() {
+  display.setCursor(0, 0);
+  display.println(F("Presets"));
+  display.println(F("-------"));
+
+  // Four rows around the selection, then the key help
+  int first = presetIndex - 3;
+  if (first < 0) first = 0;
+  char name[PRESET_NAME_LEN + 1];
+  for (int i = first; i < PRESET_COUNT && i < first + 4; i++) {
+    presets.name(i, name);
+    if (i == presetIndex) {
+      display.setTextColor(SSD1306_BLACK, SSD1306_WHITE);
+    } else {
+      display.setTextColor(SSD1306_WHITE);
+    }
+    display.print(i);
+    display.print(F(": "));
+    display.println(name[0] ? name : "(empty)");
+  }
+
+  display.setTextColor(SSD1306_WHITE);
+  display.println(F("DOWN: Next OK: Recall"));
+  display.println(F("UP: Back"));
+}
+
 void displayConfirmation(const char* message) {
   display.clearDisplay();
   display.setTextSize(2);
@@ -0,0 +1,53 @@
+// File: ITLA_Policies.h
+// Policies plugged into BasicITLA (ITLA.h) at compile time. Calls go straight
+// to inline members, so there is no virtual dispatch and an empty policy
+// leaves no code behind.
+//
+// Transport: anything with begin(long baud), write(const uint8_t *, size_t),
+//            int available() and int read() -- HardwareSerial as is.
+// Clock:     ms(), us() and sleep(ms); copied into the driver, so a host clock
+//            that is shared between objects holds a pointer to its time source.
+// Logger:    event(id, a, b, c) for errors and state changes, trace(...) for
+//            per-frame records, setVerbose(bool) to switch trace on and off.
+//            IDs and arguments as in ITLA_Log.h.
+#ifndef ITLA_POLICIES_H
+#define ITLA_POLICIES_H
+
+#include <Arduino.h>
+#include "ITLA_Log.h"
+
+// millis()/micros()/delay() of the Arduino core
+struct ArduinoClock {
+    unsigned long ms() const { return millis(); }
+    unsigned long us() const { return micros(); }
+    void sleep(unsigned long ms) const { delay(ms); }
+};
+
+// Every call is an empty inline function: the driver carries no logging code
+struct NullLogger {
+    void setVerbose(bool) {}
+    void event(uint8_t, uint8_t = 0, uint16_t = 0, uint32_t = 0) {}
+    void trace(uint8_t, uint8_t = 0, uint16_t = 0, uint32_t = 0) {}
+};
+
+// Deferred binary log (itlaLog); frame tracing only while verbose
+class RingLogger {
+public:
+    RingLogger() : traceOn(false) {}
+    void setVerbose(bool on) { traceOn = on; }
+    void event(uint8_t id, uint8_t a = 0, uint16_t b = 0, uint32_t c = 0) { itlaLog.log(id, a, b, c); }
+    void trace(uint8_t id, uint8_t a = 0, uint16_t b = 0, uint32_t c = 0) {
+        if (traceOn) itlaLog.log(id, a, b, c);
+    }
+
+private:
+    bool traceOn;
+};
+
+// Logger of the Arduino build of the driver; define as NullLogger (e.g. in
+// the board's build flags) for a build without any logging
+#ifndef ITLA_LOGGER
+#define ITLA_LOGGER RingLogger
+#endif
+
+#endif // ITLA_POLICIES_H
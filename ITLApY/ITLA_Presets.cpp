@@ -0,0 +1,40 @@
+// File: ITLA_Presets.cpp
+#include "ITLA_Presets.h"
+
+PresetBank presets;
+
+bool PresetBank::get(uint8_t n, Preset &p) {
+    if (n >= PRESET_COUNT) return false;
+    return configStore.load(CFG_REC_PRESET_BASE + n, PRESET_VERSION, &p, sizeof(p));
+}
+
+bool PresetBank::save(ITLA &itla, uint8_t n, const char *name, FreqMHz freq, PowerCdBm power, int ftfMHz) {
+    if (n >= PRESET_COUNT) return false;
+
+    Preset p;
+    memset(&p, 0, sizeof(p));
+    strncpy(p.name, name, sizeof(p.name) - 1);
+    p.name[sizeof(p.name) - 1] = '\0';
+    p.freq = freq;
+    p.channel = itla.channelForMHz(freq);
+    p.powerRaw = power;
+    p.ftfRaw = (int16_t)ftfMHz;
+    if (p.channel == 0) return false;   // no grid information from the module
+
+    configStore.stage(CFG_REC_PRESET_BASE + n, PRESET_VERSION, &p, sizeof(p));
+    return true;
+}
+
+uint8_t PresetBank::recall(ITLA &itla, uint8_t n) {
+    Preset p;
+    if (!get(n, p)) return 0xFF;
+    return itla.applyOperatingPoint(p.channel, p.powerRaw, p.ftfRaw);
+}
+
+void PresetBank::name(uint8_t n, char *buf) {
+    Preset p;
+    buf[0] = '\0';
+    if (!get(n, p)) return;
+    memcpy(buf, p.name, PRESET_NAME_LEN);
+    buf[PRESET_NAME_LEN] = '\0';
+}
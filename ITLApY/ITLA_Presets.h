@@ -0,0 +1,45 @@
+// File: ITLA_Presets.h
+// Bank of named operating points (frequency, power, fine-tune) kept in the
+// config store. The channel number and raw register values are computed when a
+// preset is saved, so recalling one is just ITLA::applyOperatingPoint().
+#ifndef ITLA_PRESETS_H
+#define ITLA_PRESETS_H
+
+#include <Arduino.h>
+#include "ITLA.h"
+#include "ITLA_ConfigStore.h"
+
+#if CFG_STORE_SMALL
+#define PRESET_COUNT     1   // small EEPROM: see CFG_STORE_SMALL
+#else
+#define PRESET_COUNT     8
+#endif
+#define PRESET_NAME_LEN  12
+#define PRESET_VERSION   2
+
+struct Preset {
+    char name[PRESET_NAME_LEN];   // NUL-terminated (records from older builds may not be)
+    FreqMHz freq;                 // as entered, for display
+    uint32_t channel;             // precomputed for the module's grid
+    PowerCdBm powerRaw;           // POWER register (dBm*100)
+    int16_t ftfRaw;               // FTF register (MHz, signed)
+};
+
+class PresetBank {
+public:
+    // Copy preset n (0-based) into p. Returns false if the slot is empty.
+    bool get(uint8_t n, Preset &p);
+
+    // Build a preset for the connected module and store it in slot n.
+    bool save(ITLA &itla, uint8_t n, const char *name, FreqMHz freq, PowerCdBm power, int ftfMHz);
+
+    // Apply preset n. Returns registers written (0 if already in effect), 0xFF on failure.
+    uint8_t recall(ITLA &itla, uint8_t n);
+
+    // Copy the preset name into buf (size >= PRESET_NAME_LEN + 1), "" if empty.
+    void name(uint8_t n, char *buf);
+};
+
+extern PresetBank presets;
+
+#endif // ITLA_PRESETS_H
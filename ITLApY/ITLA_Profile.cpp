@@ -0,0 +1,61 @@
+// File: ITLA_Profile.cpp
+#include "ITLA_Profile.h"
+
+ProfileStore profiles;
+
+bool ProfileStore::load(uint8_t slot, ModuleProfile &p) {
+    return configStore.load(CFG_REC_PROFILE_BASE + slot, PROFILE_VERSION, &p, sizeof(p));
+}
+
+void ProfileStore::store(uint8_t slot, const ModuleProfile &p) {
+    configStore.stage(CFG_REC_PROFILE_BASE + slot, PROFILE_VERSION, &p, sizeof(p));
+}
+
+void ProfileStore::setLast(uint8_t slot) {
+    uint8_t last;
+    if (configStore.load(CFG_REC_PROFILE_LAST, PROFILE_VERSION, &last, 1) && last == slot) return;
+    configStore.stage(CFG_REC_PROFILE_LAST, PROFILE_VERSION, &slot, 1);
+}
+
+// First empty slot, otherwise the one after the last-used (round robin)
+uint8_t ProfileStore::pickSlot(uint8_t last) {
+    ModuleProfile p;
+    for (uint8_t i = 0; i < PROFILE_SLOTS; i++) {
+        if (!load(i, p)) return i;
+    }
+    return (last + 1) % PROFILE_SLOTS;
+}
+
+uint8_t ProfileStore::attach(ITLA &itla) {
+    ModuleProfile p;
+    uint8_t last = PROFILE_SLOTS;
+    if (!configStore.load(CFG_REC_PROFILE_LAST, PROFILE_VERSION, &last, 1)) last = PROFILE_SLOTS;
+
+    // 1) Identify the module by serial number, the last-used slot first. The
+    // SN is what tells two units of the same model apart; GRID/FCF2 only show
+    // whether the unit was reconfigured since its profile was stored.
+    String sn = itla.readAEAString(ITLA_REG_SN);
+    uint8_t slot = PROFILE_SLOTS;
+    if (sn.length() > 0) {
+        for (uint8_t n = 0; n < PROFILE_SLOTS; n++) {
+            uint8_t i = last < PROFILE_SLOTS ? (uint8_t)((last + n) % PROFILE_SLOTS) : n;
+            if (!load(i, p) || strncmp(p.serial, sn.c_str(), ITLA_SERIAL_LEN - 1) != 0) continue;
+            if (itla.profileMatches(p)) {
+                itla.useProfile(p);
+                if (i == last) return PROFILE_CACHED;
+                setLast(i);
+                return PROFILE_KNOWN;
+            }
+            slot = i;   // same unit, reconfigured grid: rediscover in place
+            break;
+        }
+    }
+
+    // 2) Unknown module: full discovery
+    if (!itla.readProfile(p)) return PROFILE_NONE;
+    if (slot == PROFILE_SLOTS) slot = pickSlot(last < PROFILE_SLOTS ? last : PROFILE_SLOTS - 1);
+    store(slot, p);
+    setLast(slot);
+    itla.useProfile(p);
+    return PROFILE_DISCOVERED;
+}
@@ -0,0 +1,42 @@
+// File: ITLA_Profile.h
+// Persistent per-module capability profiles, keyed by serial number.
+// A reconnect to a known module, the last used or another, costs an SN read
+// and two register reads; only an unknown module gets full discovery.
+#ifndef ITLA_PROFILE_H
+#define ITLA_PROFILE_H
+
+#include <Arduino.h>
+#include "ITLA.h"
+#include "ITLA_ConfigStore.h"
+
+#if CFG_STORE_SMALL
+#define PROFILE_SLOTS    1   // small EEPROM: see CFG_STORE_SMALL
+#else
+#define PROFILE_SLOTS    4
+#endif
+#define PROFILE_VERSION  1
+
+// How attach() obtained the profile
+enum ProfileSource {
+    PROFILE_NONE,        // discovery failed, driver keeps reading GRID/FCF per call
+    PROFILE_CACHED,      // last-used module, serial number and grid still match
+    PROFILE_KNOWN,       // found by serial number among stored profiles
+    PROFILE_DISCOVERED   // new module, full discovery, now stored
+};
+
+class ProfileStore {
+public:
+    // Identify the connected module and hand its profile to the driver.
+    // Call after itla.begin() and configStore.begin().
+    uint8_t attach(ITLA &itla);
+
+private:
+    bool load(uint8_t slot, ModuleProfile &p);
+    void store(uint8_t slot, const ModuleProfile &p);
+    void setLast(uint8_t slot);
+    uint8_t pickSlot(uint8_t last);
+};
+
+extern ProfileStore profiles;
+
+#endif // ITLA_PROFILE_H
@@ -0,0 +1,64 @@
+// File: ITLA_RxRing.h
+// Single-producer/single-consumer byte ring for the receive side of a link.
+// The producer is whatever owns the incoming bytes: a UART interrupt handler,
+// a host reader thread or a simulated module; the consumer is the driver,
+// which takes bytes in batches and feeds them to an ITLAFrameAssembler
+// (ITLA_Frame.h). Same publish-after-write scheme as the button queue: each
+// side only writes its own index, so neither side needs to disable interrupts.
+// Header-only and C++11 so the Due build can use it unchanged.
+#ifndef ITLA_RXRING_H
+#define ITLA_RXRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+template <uint16_t N>   // capacity + 1, power of two
+class RxRing {
+public:
+    RxRing() : head(0), tail(0), overflows(0) {}
+
+    // Producer side (ISR safe). Returns false and counts the byte if full.
+    bool push(uint8_t b) {
+        uint16_t h = head;
+        uint16_t next = (uint16_t)((h + 1) & (N - 1));
+        if (next == tail) {
+            overflows = (uint16_t)(overflows + 1);   // no ++ on volatile (deprecated in C++20)
+            return false;
+        }
+        buf[h] = b;
+        __sync_synchronize();   // slot visible before the index that publishes it
+        head = next;
+        return true;
+    }
+
+    // Consumer side
+    int available() const { return (int)((head - tail) & (N - 1)); }
+    int read() {
+        uint16_t t = tail;
+        if (t == head) return -1;
+        uint8_t b = buf[t];
+        __sync_synchronize();   // byte taken before the slot is handed back
+        tail = (uint16_t)((t + 1) & (N - 1));
+        return b;
+    }
+    // Copy out up to len bytes; returns how many
+    size_t read(uint8_t *out, size_t len) {
+        size_t n = 0;
+        int b;
+        while (n < len && (b = read()) >= 0) out[n++] = (uint8_t)b;
+        return n;
+    }
+    // Consumer only: drop everything received so far
+    void clear() { tail = head; }
+
+    uint16_t overflowCount() const { return overflows; }
+
+private:
+    static_assert((N & (N - 1)) == 0 && N >= 2, "RxRing size must be a power of two");
+    volatile uint8_t buf[N];
+    volatile uint16_t head;       // written by the producer
+    volatile uint16_t tail;       // written by the consumer
+    volatile uint16_t overflows;  // producer only
+};
+
+#endif // ITLA_RXRING_H
@@ -0,0 +1,203 @@
+// File: ITLA_Snapshot.cpp
+#include "ITLA_Snapshot.h"
+
+SnapshotTaker snapshots;
+
+// Everything readable in ITLA_Registers.h. EAR/EAR_EXT are left out: reading
+// them consumes AEA string data. Append only, the image is indexed by position.
+static const SnapshotReg SNAPSHOT_REGS[] = {
+    { ITLA_REG_NOP, "NOP" },            { ITLA_REG_DEV_TYPE, "DEVTYP" },
+    { ITLA_REG_MANUF, "MFGR" },         { ITLA_REG_MODEL, "MODEL" },
+    { ITLA_REG_SN, "SERNO" },           { ITLA_REG_MFG_DATE, "MFGDATE" },
+    { ITLA_REG_RELEASE, "RELEASE" },    { ITLA_REG_REL_BACK, "RELBACK" },
+    { ITLA_REG_GEN_CFG, "GENCFG" },     { ITLA_REG_EA, "EA" },
+    { ITLA_REG_IOCAP, "IOCAP" },        { ITLA_REG_EAC, "EAC" },
+    { ITLA_REG_EA_EXT, "EA_EXT" },      { ITLA_REG_LSTRESP, "LSTRESP" },
+    { ITLA_REG_DL_CONFIG, "DLCONFIG" }, { ITLA_REG_DL_STATUS, "DLSTATUS" },
+    { ITLA_REG_STATUSF, "STATUSF" },    { ITLA_REG_STATUSW, "STATUSW" },
+    { ITLA_REG_FPOWTH, "FPOWTH" },      { ITLA_REG_WPOWTH, "WPOWTH" },
+    { ITLA_REG_FFREQTH, "FFREQTH" },    { ITLA_REG_WFREQTH, "WFREQTH" },
+    { ITLA_REG_FTHERMTH, "FTHERMTH" },  { ITLA_REG_WTHERMTH, "WTHERMTH" },
+    { ITLA_REG_SRQT, "SRQT" },          { ITLA_REG_FATALT, "FATALT" },
+    { ITLA_REG_ALMT, "ALMT" },          { ITLA_REG_CHANNEL, "CHANNEL" },
+    { ITLA_REG_POWER, "PWR" },          { ITLA_REG_RESETA, "RESENA" },
+    { ITLA_REG_MCB, "MCB" },            { ITLA_REG_GRID, "GRID" },
+    { ITLA_REG_FCF1, "FCF1" },          { ITLA_REG_FCF2, "FCF2" },
+    { ITLA_REG_LF1, "LF1" },            { ITLA_REG_LF2, "LF2" },
+    { ITLA_REG_OOP, "OOP" },            { ITLA_REG_TEMP, "CTEMP" },
+    { ITLA_REG_FTFR, "FTFR" },          { ITLA_REG_OPSL, "OPSL" },
+    { ITLA_REG_OPSH, "OPSH" },          { ITLA_REG_LFL1, "LFL1" },
+    { ITLA_REG_LFL2, "LFL2" },          { ITLA_REG_LFH1, "LFH1" },
+    { ITLA_REG_LFH2, "LFH2" },          { ITLA_REG_LGRID, "LGRID" },
+    { ITLA_REG_CURR, "CURRENTS" },      { ITLA_REG_TEMPS, "TEMPS" },
+    { ITLA_REG_DITHERE, "DITHERE" },    { ITLA_REG_DITHERR, "DITHERR" },
+    { ITLA_REG_DITHERF, "DITHERF" },    { ITLA_REG_DITHERA, "DITHERA" },
+    { ITLA_REG_TBTFL, "TBTFL" },        { ITLA_REG_TBTFH, "TBTFH" },
+    { ITLA_REG_FAGETH, "FAGETH" },      { ITLA_REG_WAGETH, "WAGETH" },
+    { ITLA_REG_AGE, "AGE" },            { ITLA_REG_FTF, "FTF" },
+    { ITLA_REG_FFREQTH2, "FFREQTH2" },  { ITLA_REG_WFREQTH2, "WFREQTH2" },
+    { ITLA_REG_CHANNELH, "CHANNELH" },  { ITLA_REG_GRID2, "GRID2" },
+    { ITLA_REG_FCF3, "FCF3" },          { ITLA_REG_LF3, "LF3" },
+    { ITLA_REG_LFL3, "LFL3" },          { ITLA_REG_LFH3, "LFH3" },
+    { ITLA_REG_LGRID2, "LGRID2" },
+};
+
+static const uint8_t SNAPSHOT_REG_COUNT = sizeof(SNAPSHOT_REGS) / sizeof(SNAPSHOT_REGS[0]);
+static_assert(sizeof(SNAPSHOT_REGS) / sizeof(SNAPSHOT_REGS[0]) <= SNAPSHOT_MAX_REGS, "raise SNAPSHOT_MAX_REGS");
+
+void Snapshot::setState(uint8_t i, SnapshotState s) {
+    uint8_t shift = (i & 3) * 2;
+    state[i >> 2] = (uint8_t)((state[i >> 2] & ~(3 << shift)) | (s << shift));
+}
+
+SnapshotTaker::SnapshotTaker() {
+    forget();
+}
+
+void SnapshotTaker::forget() {
+    memset(modules, 0, sizeof(modules));
+}
+
+uint8_t SnapshotTaker::regCount() {
+    return SNAPSHOT_REG_COUNT;
+}
+
+const SnapshotReg &SnapshotTaker::regAt(uint8_t i) {
+    return SNAPSHOT_REGS[i];
+}
+
+SnapshotTaker::ModuleRni *SnapshotTaker::moduleFor(const char *serial, bool create) {
+    if (serial[0] == '\0') return 0;
+    ModuleRni *hit = 0;
+    ModuleRni *oldest = &modules[0];
+    for (uint8_t i = 0; i < SNAPSHOT_MODULES; i++) {
+        ModuleRni &m = modules[i];
+        if (strncmp(m.serial, serial, ITLA_SERIAL_LEN) == 0) hit = &m;
+        if (m.age > oldest->age || m.serial[0] == '\0') oldest = &m;
+    }
+    if (!hit) {
+        if (!create) return 0;
+        // Replace the least recently used (or an empty) entry
+        hit = oldest;
+        memset(hit, 0, sizeof(*hit));
+        memcpy(hit->serial, serial, ITLA_SERIAL_LEN);
+    }
+    for (uint8_t i = 0; i < SNAPSHOT_MODULES; i++) {
+        if (modules[i].age < 0xFF) modules[i].age++;
+    }
+    hit->age = 0;
+    return hit;
+}
+
+void SnapshotTaker::learn(const Snapshot &s) {
+    if (s.version != SNAPSHOT_VERSION) return;
+    ModuleRni *m = moduleFor(s.serial, true);
+    if (!m) return;
+    for (uint8_t i = 0; i < s.count && i < SNAPSHOT_REG_COUNT; i++) {
+        uint8_t reg = SNAPSHOT_REGS[i].reg;
+        if (s.stateOf(i) == SNAP_RNI) m->rni[reg >> 3] |= (uint8_t)(1 << (reg & 7));
+    }
+}
+
+uint8_t SnapshotTaker::take(ITLA &itla, Snapshot &s) {
+    memset(&s, 0, sizeof(s));
+    s.version = SNAPSHOT_VERSION;
+    s.count = SNAPSHOT_REG_COUNT;
+    const ModuleProfile *p = itla.profile();
+    if (p) memcpy(s.serial, p->serial, ITLA_SERIAL_LEN);
+    ModuleRni *m = moduleFor(s.serial, true);
+
+    uint8_t read = 0;
+    s.takenMs = millis();
+    for (uint8_t i = 0; i < SNAPSHOT_REG_COUNT; i++) {
+        uint8_t reg = SNAPSHOT_REGS[i].reg;
+        if (m && (m->rni[reg >> 3] & (1 << (reg & 7)))) {
+            s.setState(i, SNAP_RNI);
+            continue;
+        }
+        uint16_t v = itla.readRegister(reg);
+        uint8_t st = itla.lastStatus();
+        if (st == 0) {
+            s.setState(i, SNAP_VALUE);
+            s.value[i] = v;
+            read++;
+        } else if (st == 2) {
+            s.setState(i, SNAP_AEA);
+            s.value[i] = v;
+            read++;
+        } else if (st == 1 && itla.lastErrorCode() == ITLA_ERR_RNI) {
+            s.setState(i, SNAP_RNI);
+            if (m) m->rni[reg >> 3] |= (uint8_t)(1 << (reg & 7));
+        } else {
+            s.setState(i, SNAP_FAILED);
+            s.value[i] = st == 1 ? itla.lastErrorCode() : st;
+        }
+    }
+    unsigned long ms = millis() - s.takenMs;
+    s.durationMs = ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+    return read;
+}
+
+static void printEntry(SnapshotState st, uint16_t v, Print &out) {
+    switch (st) {
+        case SNAP_RNI:    out.print("RNI"); break;
+        case SNAP_AEA:    out.print("AEA len "); out.print(v); break;
+        case SNAP_FAILED: out.print("failed 0x"); out.print(v, HEX); break;
+        default:          out.print("0x"); out.print(v, HEX); break;
+    }
+}
+
+static void printRegName(uint8_t i, Print &out) {
+    out.print("0x");
+    if (SNAPSHOT_REGS[i].reg < 0x10) out.print('0');
+    out.print(SNAPSHOT_REGS[i].reg, HEX);
+    out.print(' ');
+    out.print(SNAPSHOT_REGS[i].name);
+    out.print(": ");
+}
+
+void printSnapshot(const Snapshot &s, Print &out) {
+    out.print("Snapshot ");
+    out.print(s.serial[0] ? s.serial : "(no serial)");
+    out.print(" at ");
+    out.print((unsigned long)s.takenMs);
+    out.print(" ms, ");
+    out.print(s.durationMs);
+    out.println(" ms pass");
+    for (uint8_t i = 0; i < s.count && i < SNAPSHOT_REG_COUNT; i++) {
+        printRegName(i, out);
+        printEntry(s.stateOf(i), s.value[i], out);
+        out.println();
+    }
+}
+
+uint8_t diffSnapshots(const Snapshot &a, const Snapshot &b, Print &out) {
+    if (a.version != SNAPSHOT_VERSION || b.version != SNAPSHOT_VERSION) {
+        out.println("Snapshot version mismatch");
+        return 0;
+    }
+    if (strncmp(a.serial, b.serial, ITLA_SERIAL_LEN) != 0) {
+        out.print("Different modules: ");
+        out.print(a.serial);
+        out.print(" / ");
+        out.println(b.serial);
+    }
+    uint8_t changes = 0;
+    uint8_t n = a.count < b.count ? a.count : b.count;
+    for (uint8_t i = 0; i < n && i < SNAPSHOT_REG_COUNT; i++) {
+        SnapshotState sa = a.stateOf(i), sb = b.stateOf(i);
+        bool hasValue = sa != SNAP_RNI;
+        if (sa == sb && (!hasValue || a.value[i] == b.value[i])) continue;
+        printRegName(i, out);
+        printEntry(sa, a.value[i], out);
+        out.print(" -> ");
+        printEntry(sb, b.value[i], out);
+        out.println();
+        changes++;
+    }
+    out.print(changes);
+    out.print(" changed over ");
+    out.print((long)(int32_t)(b.takenMs - a.takenMs));
+    out.println(" ms");
+    return changes;
+}
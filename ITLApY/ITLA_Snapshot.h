@@ -0,0 +1,82 @@
+// File: ITLA_Snapshot.h
+// Whole-module register capture. One pass reads every readable register in
+// ITLA_Registers.h into a compact, fixed-layout image (values plus a 2-bit
+// state per register and the pass timestamps), so two captures taken before
+// and after a field problem can be diffed instead of reading registers one
+// by one from the OLED or GUI.
+// Registers the module answers with RNI are remembered per serial number and
+// skipped by later passes, which saves the XE frame and the NOP error read.
+#ifndef ITLA_SNAPSHOT_H
+#define ITLA_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "ITLA.h"
+
+#define SNAPSHOT_VERSION  1
+#define SNAPSHOT_MAX_REGS 80    // capacity of the image, multiple of 4
+#define SNAPSHOT_MODULES  4     // modules whose RNI set is remembered
+
+// Per-register state in the image
+enum SnapshotState {
+    SNAP_RNI,       // not implemented (answered RNI now or on an earlier pass)
+    SNAP_VALUE,     // value read
+    SNAP_AEA,       // AEA string register; value is the string length
+    SNAP_FAILED     // XE with another code (value = ITLA_ERR_*), CP, or no response
+};
+
+// One entry of the readable-register table
+struct SnapshotReg {
+    uint8_t reg;
+    const char *name;
+};
+
+// Binary image. Plain data, little-endian on both the Due and the host, so it
+// can be written to a file or dumped as hex and read back as is.
+struct Snapshot {
+    uint8_t version;                       // SNAPSHOT_VERSION
+    uint8_t count;                         // table entries captured
+    uint16_t durationMs;                   // length of the pass
+    uint32_t takenMs;                      // millis() when the pass started
+    char serial[ITLA_SERIAL_LEN];          // module SN from the profile, NUL-padded
+    uint8_t state[SNAPSHOT_MAX_REGS / 4];  // SnapshotState, 2 bits per entry
+    uint16_t value[SNAPSHOT_MAX_REGS];
+
+    SnapshotState stateOf(uint8_t i) const { return (SnapshotState)((state[i >> 2] >> ((i & 3) * 2)) & 3); }
+    void setState(uint8_t i, SnapshotState s);
+};
+
+class SnapshotTaker {
+public:
+    SnapshotTaker();
+
+    // Read every table register once, skipping the module's known RNI set.
+    // Needs the driver's profile for the serial number (without one nothing
+    // is cached). Returns the number of registers read.
+    uint8_t take(ITLA &itla, Snapshot &s);
+
+    // Seed the RNI set from an earlier image of the same module
+    void learn(const Snapshot &s);
+    void forget();
+
+    static uint8_t regCount();
+    static const SnapshotReg &regAt(uint8_t i);
+
+private:
+    struct ModuleRni {
+        char serial[ITLA_SERIAL_LEN];
+        uint8_t rni[16];                   // bit per register address 0x00-0x7F
+        uint8_t age;                       // for replacement
+    };
+    ModuleRni modules[SNAPSHOT_MODULES];
+
+    ModuleRni *moduleFor(const char *serial, bool create);
+};
+
+// Print registers whose state or value differ between a and b; returns how many
+uint8_t diffSnapshots(const Snapshot &a, const Snapshot &b, Print &out);
+// One line per register of s
+void printSnapshot(const Snapshot &s, Print &out);
+
+extern SnapshotTaker snapshots;
+
+#endif // ITLA_SNAPSHOT_H
@@ -1,8 +1,10 @@
 // File: ITLA_Test.ino
 #include <Arduino.h>
 #include "ITLA.h"
+#include "ITLA_Log.h"
 
-ITLA itla(Serial1); // object for ITLA communication ITLA class itla object with Serial1 itla.any function define in ITLA.h
+ITLASerial itlaPort(Serial1);
+ITLA itla(itlaPort); // object for ITLA communication ITLA class itla object with Serial1 itla.any function define in ITLA.h
 // serial1 passing to ITLA class constructor as a parameter
 // when someone create an object of ITLA class, it will use Serial1 by default
 // inside ITLA class constructor, itlaSerial will be initialized with Serial1 serial to serial1
@@ -13,6 +15,7 @@ void setup() {
     Serial.println("ITLA Test Start");
 
     bool ok = itla.begin(true); // verbose debug
+    while (itlaLog.drain(Serial));   // auto-baud attempts and frames
     if (!ok) {
         Serial.println("ITLA not responding!");
         while(1);
@@ -50,5 +53,5 @@ void setup() {
 }
 
 void loop() {
-    
+    itlaLog.drain(Serial);   // verbose frame log, a few records per pass
 }
@@ -0,0 +1,72 @@
+// File: ITLA_Trace.cpp
+#include "ITLA_Trace.h"
+
+ITLATrace itlaTrace;
+
+ITLATrace::ITLATrace() : head(0), tail(0), seq(0), droppedTotal(0), running(false), headerDue(false) {}
+
+void ITLATrace::start(uint32_t nowUs) {
+    head = tail = 0;
+    seq = 0;
+    droppedTotal = 0;
+    headerDue = true;
+    running = true;
+    uint8_t v = TRACE_VERSION;
+    record(nowUs, TRACE_START, &v, 1);
+}
+
+void ITLATrace::record(uint32_t timeUs, uint8_t kind, const uint8_t *data, uint8_t len) {
+    if (!running) return;
+    uint16_t s = seq++;
+    if ((uint16_t)(head - tail) == TRACE_RING_RECORDS) {
+        droppedTotal++;   // keep what is queued; the seq gap marks the loss
+        return;
+    }
+    TraceRecord &r = ring[head & (TRACE_RING_RECORDS - 1)];
+    r.timeUs = timeUs;
+    r.kind = kind;
+    r.len = len;
+    r.seq = s;
+    for (uint8_t i = 0; i < sizeof(r.data); i++) r.data[i] = i < len ? data[i] : 0;
+    head++;
+}
+
+static void printHex(Print &out, const uint8_t *p, uint8_t n) {
+    static const char digits[] = "0123456789abcdef";
+    char buf[2 * sizeof(TraceRecord) + 1];
+    for (uint8_t i = 0; i < n; i++) {
+        buf[2 * i] = digits[p[i] >> 4];
+        buf[2 * i + 1] = digits[p[i] & 0x0F];
+    }
+    buf[2 * n] = '\0';
+    out.print(buf);
+}
+
+uint8_t ITLATrace::drain(Print &out, uint8_t maxRecords) {
+    if (head == tail) return 0;
+    out.print(TRACE_LINE_PREFIX);
+    uint8_t n = 0;
+    while (n < maxRecords && head != tail) {
+        printHex(out, (const uint8_t *)&ring[tail & (TRACE_RING_RECORDS - 1)], sizeof(TraceRecord));
+        tail++;
+        n++;
+    }
+    out.println();
+    headerDue = false;   // the console form has no header; itla_trace convert adds it
+    return n;
+}
+
+uint8_t ITLATrace::drainBinary(Print &out, uint8_t maxRecords) {
+    if (headerDue) {
+        TraceHeader h = { TRACE_MAGIC, TRACE_VERSION, sizeof(TraceRecord), 0 };
+        out.write((const uint8_t *)&h, sizeof(h));
+        headerDue = false;
+    }
+    uint8_t n = 0;
+    while (n < maxRecords && head != tail) {
+        out.write((const uint8_t *)&ring[tail & (TRACE_RING_RECORDS - 1)], sizeof(TraceRecord));
+        tail++;
+        n++;
+    }
+    return n;
+}
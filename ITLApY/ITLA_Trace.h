@@ -0,0 +1,143 @@
+// File: ITLA_Trace.h
+// Wire trace: every byte the driver sends or receives, with micros() and
+// direction, as fixed 12-byte records. TracingTransport sits between the
+// driver and its serial port and copies traffic into the itlaTrace RAM ring
+// while a trace is running; drain() (console, '%' hex lines) or
+// drainBinary() (a file or an SD card File, raw records after a header)
+// moves records out from idle time in loop(), like the log in ITLA_Log.h.
+// The binary form is append-only and fixed-stride, so host/itla_trace can
+// mmap multi-hour captures and replay them into the driver or the simulator.
+//
+// File:   TraceHeader, then TraceRecords, all little-endian
+// Times:  32-bit micros(); readers unwrap, assuming records closer than 71 min
+// Gaps:   seq counts every record taken, so records dropped on a full ring
+//         (newest are dropped, the order of what is kept never changes)
+//         show up as jumps in seq
+// Not for use from interrupt handlers.
+#ifndef ITLA_TRACE_H
+#define ITLA_TRACE_H
+
+#include <Arduino.h>
+#include "ITLA_Policies.h"
+
+#define TRACE_RING_RECORDS 64   // power of two
+#define TRACE_LINE_PREFIX  '%'
+#define TRACE_MAGIC        "ITLATRC"   // + NUL: 8 bytes
+#define TRACE_VERSION      1
+
+enum TraceKind {
+    TRACE_TX = 1,     // bytes written; len = 1..4
+    TRACE_RX = 2,     // bytes read; len = 1..4, time of the last one
+    TRACE_BAUD = 3,   // line (re)opened; data = baud, uint32
+    TRACE_START = 4   // trace started; data = TRACE_VERSION
+};
+
+struct TraceHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t reserved;
+};
+
+struct TraceRecord {
+    uint32_t timeUs;
+    uint8_t kind;     // TraceKind
+    uint8_t len;      // valid bytes in data
+    uint16_t seq;
+    uint8_t data[4];
+};
+
+static_assert(sizeof(TraceHeader) == 16 && sizeof(TraceRecord) == 12, "trace layout is part of the file format");
+
+class ITLATrace {
+public:
+    static const uint8_t DRAIN_RECORDS = 4;   // per drain() call, keeps loop() passes short
+
+    ITLATrace();
+
+    // start() empties the ring; the next drainBinary() begins with a header
+    void start(uint32_t nowUs);
+    void stop() { running = false; }
+    bool active() const { return running; }
+
+    void record(uint32_t timeUs, uint8_t kind, const uint8_t *data, uint8_t len);
+
+    // Up to maxRecords pending records as one '%' hex line; returns how many
+    uint8_t drain(Print &out, uint8_t maxRecords = DRAIN_RECORDS);
+    // Up to maxRecords pending records as raw bytes, header first
+    uint8_t drainBinary(Print &out, uint8_t maxRecords = DRAIN_RECORDS);
+
+    uint16_t pending() const { return (uint16_t)(head - tail); }
+    uint32_t dropped() const { return droppedTotal; }
+
+private:
+    TraceRecord ring[TRACE_RING_RECORDS];
+    uint16_t head, tail;    // free-running, masked on access
+    uint16_t seq;
+    uint32_t droppedTotal;
+    bool running;
+    bool headerDue;
+};
+
+extern ITLATrace itlaTrace;
+
+// Transport decorator (ITLA_Policies.h): forwards to the port and, while
+// itlaTrace is running, records what went through. Received bytes are
+// grouped up to four per record; a write or a baud change closes the group.
+// Clock only needs us().
+template <class Port, class Clock = ArduinoClock>
+class TracingTransport {
+public:
+    explicit TracingTransport(Port &port, const Clock &clock = Clock(), ITLATrace &trace = itlaTrace)
+        : port(port), clock(clock), trace(trace), rxLen(0), rxUs(0) {}
+
+    void begin(long baud) {
+        if (trace.active()) {
+            flushRx();
+            uint32_t b = (uint32_t)baud;
+            trace.record(clock.us(), TRACE_BAUD, (const uint8_t *)&b, sizeof(b));
+        }
+        rxLen = 0;
+        port.begin(baud);
+    }
+
+    size_t write(const uint8_t *buf, size_t len) {
+        if (trace.active()) {
+            flushRx();
+            uint32_t t = clock.us();
+            for (size_t i = 0; i < len; i += 4)
+                trace.record(t, TRACE_TX, buf + i, (uint8_t)(len - i < 4 ? len - i : 4));
+        }
+        rxLen = 0;
+        return port.write(buf, len);
+    }
+
+    int available() { return port.available(); }
+
+    int read() {
+        int b = port.read();
+        if (b >= 0 && trace.active()) {
+            rxUs = clock.us();   // the driver acts once a frame is complete
+            rxBuf[rxLen++] = (uint8_t)b;
+            if (rxLen == sizeof(rxBuf)) flushRx();
+        }
+        return b;
+    }
+
+    Port &underlying() { return port; }
+
+private:
+    Port &port;
+    Clock clock;
+    ITLATrace &trace;
+    uint8_t rxBuf[4];
+    uint8_t rxLen;
+    uint32_t rxUs;
+
+    void flushRx() {
+        if (rxLen) trace.record(rxUs, TRACE_RX, rxBuf, rxLen);
+        rxLen = 0;
+    }
+};
+
+#endif // ITLA_TRACE_H
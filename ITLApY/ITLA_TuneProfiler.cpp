@@ -0,0 +1,124 @@
+// File: ITLA_TuneProfiler.cpp
+#include "ITLA_TuneProfiler.h"
+
+TuneProfiler tuneProfiler;
+
+TuneProfiler::TuneProfiler() : window(DEFAULT_WINDOW_MHZ) {
+    memset(serial, 0, sizeof(serial));
+    clear();
+}
+
+void TuneProfiler::clear() {
+    memset(cells, 0, sizeof(cells));
+}
+
+bool TuneProfiler::attach(ITLA &itla) {
+    const ModuleProfile *p = itla.profile();
+    if (!p) return false;
+
+    if (strncmp(serial, p->serial, ITLA_SERIAL_LEN) != 0) {
+        clear();   // different unit, its timings say nothing about this one
+        memcpy(serial, p->serial, ITLA_SERIAL_LEN);
+    }
+    plan = itla.channelPlan();
+
+    // Warning threshold is the tighter window; the fatal one is the fallback.
+    // Both are GHz*10 + MHz pairs; RNI reads back as 0.
+    window = (int32_t)itla.readRegister(ITLA_REG_WFREQTH) * MHZ_PER_GHZ10 + itla.readRegister(ITLA_REG_WFREQTH2);
+    if (window <= 0) {
+        window = (int32_t)itla.readRegister(ITLA_REG_FFREQTH) * MHZ_PER_GHZ10 + itla.readRegister(ITLA_REG_FFREQTH2);
+    }
+    if (window <= 0) window = DEFAULT_WINDOW_MHZ;
+
+    itla.useTuneProfiler(this);
+    return true;
+}
+
+uint8_t TuneProfiler::bandOf(uint32_t channel) const {
+    if (!plan.valid()) return 0;
+    uint32_t ch = plan.step(channel, 0);   // clamp into the plan
+    return (uint8_t)((ch - plan.firstChannel()) * TUNE_BANDS / plan.count());
+}
+
+bool TuneProfiler::tune(ITLA &itla, uint32_t channel, TuneResult &r) {
+    memset(&r, 0, sizeof(r));
+    r.from = itla.getChannel();
+    r.to = channel;
+    if (!itla.setChannel(channel)) return false;
+    unsigned long t0 = itla.clockMs();
+
+    // 1) Module reports the tune done. A timeout or a failed poll (link
+    // trouble) is not a tuning result: nothing is recorded.
+    if (!itla.waitPending(SETTLE_TIMEOUT_MS)) return true;
+    r.pendingMs = (uint16_t)(itla.clockMs() - t0);
+
+    // 2) Measured frequency holds inside the window for HOLD_READS reads
+    FreqMHz target = plan.valid() ? plan.frequency(channel) : itla.getFrequencyMHz();
+    uint8_t inside = 0;
+    unsigned long enteredMs = 0;
+    while (itla.clockMs() - t0 < SETTLE_TIMEOUT_MS) {
+        unsigned long now = itla.clockMs();
+        FreqMHz lf = itla.getFrequencyLFMHz();
+        if (itla.lastStatus() != 0) return true;   // link trouble, not a tuning result
+        r.errorMHz = (int32_t)(lf - target);
+        int32_t absErr = r.errorMHz < 0 ? -r.errorMHz : r.errorMHz;
+        if (absErr <= window) {
+            if (inside++ == 0) enteredMs = now;
+            if (inside >= HOLD_READS) {
+                r.settleMs = (uint16_t)(enteredMs - t0);
+                if (r.settleMs < r.pendingMs) r.settleMs = r.pendingMs;
+                r.settled = true;
+                record(r);
+                return true;
+            }
+        } else {
+            inside = 0;
+        }
+        itla.pause(POLL_MS);
+    }
+    return true;
+}
+
+void TuneProfiler::record(const TuneResult &r) {
+    TuneCell &c = cells[bandOf(r.from)][bandOf(r.to)];
+    if (c.count == 0) {
+        c.pendingMs = r.pendingMs;
+        c.settleMs = r.settleMs;
+    } else {
+        c.pendingMs = (uint16_t)((int32_t)c.pendingMs + ((int32_t)r.pendingMs - (int32_t)c.pendingMs) / 4);
+        c.settleMs = (uint16_t)((int32_t)c.settleMs + ((int32_t)r.settleMs - (int32_t)c.settleMs) / 4);
+    }
+    if (c.count < BASELINE_SAMPLES) {
+        c.baselineMs = (uint16_t)(((uint32_t)c.baselineMs * c.count + r.settleMs) / (c.count + 1));
+    }
+    if (r.settleMs > c.maxMs) c.maxMs = r.settleMs;
+    if (c.count < 0xFFFF) c.count++;
+}
+
+uint16_t TuneProfiler::meanOf(uint16_t TuneCell::*field) const {
+    uint32_t sum = 0;
+    uint16_t n = 0;
+    for (uint8_t i = 0; i < TUNE_BANDS; i++) {
+        for (uint8_t j = 0; j < TUNE_BANDS; j++) {
+            if (cells[i][j].count == 0) continue;
+            sum += cells[i][j].*field;
+            n++;
+        }
+    }
+    return n ? (uint16_t)(sum / n) : 0;
+}
+
+uint16_t TuneProfiler::settleEstimateMs(uint32_t from, uint32_t to) const {
+    const TuneCell &c = cells[bandOf(from)][bandOf(to)];
+    return c.count ? c.settleMs : meanOf(&TuneCell::settleMs);
+}
+
+uint16_t TuneProfiler::pendingEstimateMs(uint32_t from, uint32_t to) const {
+    const TuneCell &c = cells[bandOf(from)][bandOf(to)];
+    return c.count ? c.pendingMs : meanOf(&TuneCell::pendingMs);
+}
+
+bool TuneProfiler::slowing(uint8_t fromBand, uint8_t toBand) const {
+    const TuneCell &c = cells[fromBand][toBand];
+    return c.count >= 2 * BASELINE_SAMPLES && c.settleMs > c.baselineMs + c.baselineMs / 2;
+}
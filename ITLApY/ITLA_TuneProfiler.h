@@ -0,0 +1,78 @@
+// File: ITLA_TuneProfiler.h
+// Measures how long the attached module takes to change channel: CHANNEL write
+// -> pending flag clear -> LF1/2/3 readback holding inside the frequency
+// threshold window (WFREQTH/WFREQTH2, else FFREQTH/FFREQTH2). Results go into
+// a from->to map over bands of the channel plan, so callers (and the driver's
+// pending-op wait) can use the module's own settle time instead of a fixed
+// worst-case delay, and units whose tuning is slowing down stand out.
+#ifndef ITLA_TUNEPROFILER_H
+#define ITLA_TUNEPROFILER_H
+
+#include <Arduino.h>
+#include "ITLA.h"
+
+#define TUNE_BANDS 8   // channel plan split into this many bands per axis
+
+// One measured channel change
+struct TuneResult {
+    uint32_t from, to;
+    uint16_t pendingMs;    // CHANNEL write accepted -> NOP pending flags clear
+    uint16_t settleMs;     // CHANNEL write accepted -> LF held inside the window
+    int32_t errorMHz;      // final LF readback minus target
+    bool settled;          // false if the window was not reached before the timeout
+};
+
+// Statistics for one from-band -> to-band cell
+struct TuneCell {
+    uint16_t pendingMs;    // smoothed (1/4 EWMA)
+    uint16_t settleMs;     // smoothed (1/4 EWMA)
+    uint16_t baselineMs;   // mean settle time of the first samples
+    uint16_t maxMs;
+    uint16_t count;
+};
+
+class TuneProfiler {
+public:
+    static const uint8_t HOLD_READS = 3;               // consecutive LF reads inside the window
+    static const unsigned long SETTLE_TIMEOUT_MS = 30000;
+    static const uint8_t POLL_MS = 5;
+    static const uint8_t BASELINE_SAMPLES = 4;
+    static const int32_t DEFAULT_WINDOW_MHZ = 500;     // when the module reports no thresholds
+
+    TuneProfiler();
+
+    // Bind to the module the driver currently has a profile for. The map is
+    // kept if it is the same unit as before, cleared otherwise. Reads the
+    // frequency threshold registers and registers with the driver.
+    bool attach(ITLA &itla);
+
+    // Change channel and time it. Returns false if the write was refused;
+    // r is filled either way (settled false on refusal or timeout).
+    bool tune(ITLA &itla, uint32_t channel, TuneResult &r);
+
+    // Expected times for a from->to change in ms, 0 if nothing measured yet.
+    // Falls back to the mean over all cells when this cell has no samples.
+    uint16_t settleEstimateMs(uint32_t from, uint32_t to) const;
+    uint16_t pendingEstimateMs(uint32_t from, uint32_t to) const;
+
+    // Smoothed settle time has grown 50% above the cell's baseline
+    bool slowing(uint8_t fromBand, uint8_t toBand) const;
+
+    const TuneCell &cell(uint8_t fromBand, uint8_t toBand) const { return cells[fromBand][toBand]; }
+    uint8_t bandOf(uint32_t channel) const;
+    int32_t windowMHz() const { return window; }
+    void clear();
+
+private:
+    TuneCell cells[TUNE_BANDS][TUNE_BANDS];
+    ChannelPlan plan;
+    char serial[ITLA_SERIAL_LEN];
+    int32_t window;
+
+    void record(const TuneResult &r);
+    uint16_t meanOf(uint16_t TuneCell::*field) const;
+};
+
+extern TuneProfiler tuneProfiler;
+
+#endif // ITLA_TUNEPROFILER_H
@@ -0,0 +1,71 @@
+// File: ITLA_Units.h
+// Integer quantity types for the driver and UI. The Due's Cortex-M3 has no
+// FPU, so frequency and power stay in integers from register to register and
+// doubles appear only where a human types or reads a value.
+//   frequency: MHz   (FCF/LF registers are THz + 0.1 GHz + MHz digits)
+//   power:     0.01 dBm (exactly the POWER/OOP register encoding)
+// All conversions are constexpr (C++11 single-expression form for the Due toolchain).
+#ifndef ITLA_UNITS_H
+#define ITLA_UNITS_H
+
+#include <stdint.h>
+
+typedef int64_t FreqMHz;     // optical frequency
+typedef int16_t PowerCdBm;   // optical power, 0.01 dBm
+
+#define MHZ_PER_THZ    1000000LL
+#define MHZ_PER_GHZ10  100          // one unit of FCF2/LF2/LFL2/LFH2 (0.1 GHz)
+
+// ---------- Register encodings ----------
+
+// (THz, GHz*10, MHz) register triple -> MHz
+constexpr FreqMHz freqFromRegs(uint16_t thz, uint16_t ghz10, uint16_t mhz) {
+    return (FreqMHz)thz * MHZ_PER_THZ + (FreqMHz)ghz10 * MHZ_PER_GHZ10 + mhz;
+}
+
+constexpr uint16_t freqRegTHz(FreqMHz f)   { return (uint16_t)(f / MHZ_PER_THZ); }
+constexpr uint16_t freqRegGHz10(FreqMHz f) { return (uint16_t)((f % MHZ_PER_THZ) / MHZ_PER_GHZ10); }
+constexpr uint16_t freqRegMHz(FreqMHz f)   { return (uint16_t)(f % MHZ_PER_GHZ10); }
+
+// GRID (0.1 GHz, signed) + GRID2 (MHz, signed) -> MHz
+constexpr int32_t gridFromRegs(uint16_t grid, uint16_t grid2) {
+    return (int32_t)(int16_t)grid * MHZ_PER_GHZ10 + (int16_t)grid2;
+}
+
+// ---------- Channel math (exact) ----------
+
+// Frequency of channel ch (channel 1 is the first channel)
+constexpr FreqMHz channelFreq(FreqMHz first, int32_t gridMHz, uint32_t ch) {
+    return first + (FreqMHz)((int32_t)ch - 1) * gridMHz;
+}
+
+// Round-to-nearest signed division; offsets within a tuning range fit 32 bits,
+// which keeps this on the M3's hardware divider
+constexpr int32_t divRound(int32_t num, int32_t den) {
+    return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+// Nearest channel to f, or 0 if the grid is unknown
+constexpr uint32_t channelFor(FreqMHz first, int32_t gridMHz, FreqMHz f) {
+    return gridMHz <= 0 ? 0 : (uint32_t)(divRound((int32_t)(f - first), gridMHz) + 1);
+}
+
+// ---------- UI edge ----------
+
+constexpr FreqMHz freqFromTHz(double thz) {
+    return (FreqMHz)(thz * MHZ_PER_THZ + (thz >= 0 ? 0.5 : -0.5));
+}
+
+constexpr double freqToTHz(FreqMHz f) {
+    return (double)f / MHZ_PER_THZ;
+}
+
+constexpr PowerCdBm powerFromDbm(double dBm) {
+    return (PowerCdBm)(dBm * 100.0 + (dBm >= 0 ? 0.5 : -0.5));
+}
+
+constexpr double powerToDbm(PowerCdBm p) {
+    return p / 100.0;
+}
+
+#endif // ITLA_UNITS_H
@@ -1,73 +1,182 @@
 #include <Arduino.h>
-#include <EEPROM.h>
 #include "ITLA.h"
+#include "ITLA_ConfigStore.h"
+#include "ITLA_Presets.h"
+#include "ITLA_Profile.h"
+#include "ITLA_TuneProfiler.h"
+#include "ITLA_Snapshot.h"
+#include "ITLA_Log.h"
+#include "ITLA_Trace.h"
+#include "ITLA_LoopProfiler.h"
+#include "ITLA_BootTrace.h"
 
-ITLA itla(Serial1);
+ITLASerial itlaPort(Serial1);   // Serial1 with the wire-trace tap
+ITLA itla(itlaPort);
 
 // Variables to store config
-double savedFreq = 193.50;       // default THz if EEPROM empty
-int32_t savedPower_milli = 0;    // power in milli-dBm for high precision
+FreqMHz savedFreq = 193500000;    // default 193.50 THz if no stored config
+PowerCdBm savedPower = 0;         // POWER register units (0.01 dBm)
 bool savedLaserEnable = false;    // always force off at startup
 
-// EEPROM save/load
+// Last register capture, for SNAPSHOT_DIFF
+Snapshot lastSnapshot;
+bool haveSnapshot = false;
+
+// loop() sections for PROFILE
+uint8_t secCommand, secSync, secLink, secConfig, secDrain;
+
+// Longest wait for a host to open the port; a headless rack boots without one
+#define SERIAL_WAIT_MS 250
+
+// Setup work that does not need the module, run during the ITLA probe
+BootSteps bootSteps;
+bool configLoaded = false;
+
+// Persisted layout of the config record (bump CONFIG_VERSION when it changes)
+#define CONFIG_VERSION 2
+struct SavedConfig {
+    FreqMHz freq;
+    PowerCdBm power;
+    uint8_t laserEnable;
+};
+
+// Version 1 layout (double THz, milli-dBm), migrated on load
+struct SavedConfigV1 {
+    double freq;
+    int32_t power_milli;
+    uint8_t laserEnable;
+};
+
+// Config save/load through the journaled store. saveConfig() only stages the
+// record; configStore.poll() in loop() writes it once a burst of commands settles.
 void saveConfig() {
-    EEPROM.put(0, savedFreq);
-    EEPROM.put(8, savedPower_milli);   // 8 bytes offset for double
-    EEPROM.put(12, savedLaserEnable);
-    // EEPROM.commit(); // only needed on ESP, safe on AVR
+    SavedConfig cfg;
+    cfg.freq = savedFreq;
+    cfg.power = savedPower;
+    cfg.laserEnable = savedLaserEnable;
+    configStore.stage(CFG_REC_CONFIG, CONFIG_VERSION, &cfg, sizeof(cfg));
 }
 
-void loadConfig() {
-    EEPROM.get(0, savedFreq);
-    EEPROM.get(8, savedPower_milli);
-    EEPROM.get(12, savedLaserEnable);
+bool loadConfig() {
+    configStore.begin();
+    SavedConfig cfg;
+    SavedConfigV1 old;
+    bool found = configStore.load(CFG_REC_CONFIG, CONFIG_VERSION, &cfg, sizeof(cfg));
+    if (found) {
+        savedFreq = cfg.freq;
+        savedPower = cfg.power;
+        savedLaserEnable = cfg.laserEnable;
+    } else if (configStore.load(CFG_REC_CONFIG, 1, &old, sizeof(old))) {
+        savedFreq = freqFromTHz(old.freq);
+        savedPower = (PowerCdBm)((old.power_milli + (old.power_milli >= 0 ? 5 : -5)) / 10);
+        found = true;
+    }
 
     // safety: always disable laser on boot
     savedLaserEnable = false;
+    return found;
+}
+
+void loadConfigStep() {
+    configLoaded = loadConfig();
 }
 
 // --- Periodic Sync Function --- //
 void syncITLA() {
+    LOOP_PROBE(secSync);
     // Read actual laser state
-    double currentFreq = itla.getFrequencyTHz();
-    double currentPower = itla.getPower_dBm();
+    FreqMHz currentFreq = itla.getFrequencyMHz();
+    PowerCdBm currentPower = itla.getPower();
     double tempC = itla.getTemperature();
 
     // Send JSON to GUI
     Serial.print("{\"freq\":");
-    Serial.print(currentFreq, 6);    // 6 decimals for THz
+    Serial.print(freqToTHz(currentFreq), 6);    // 6 decimals for THz
     Serial.print(",\"power\":");
-    Serial.print(currentPower, 3);   // 3 decimals for dBm
+    Serial.print(powerToDbm(currentPower), 3);   // 3 decimals for dBm
     Serial.print(",\"temp\":");
     Serial.print(tempC, 2);          // 2 decimals for °C
     Serial.println("}");
 }
 
 void setup() {
+    uint8_t phase = bootTrace.start("serial");
     Serial.begin(115200);
-    while (!Serial);
+    while (!Serial && millis() < SERIAL_WAIT_MS);
+    bootTrace.end(phase);
     Serial.println("ITLA Test Start");
 
-    if (!itla.begin(true)) {
+    // The config load overlaps the auto-baud settle waits
+    bootSteps.add("config load", loadConfigStep);
+    itla.setYieldHook(BootSteps::yieldHook, &bootSteps);
+    phase = bootTrace.start("itla probe");
+    bool found = itla.begin(true);
+    bootTrace.end(phase);
+    itla.setYieldHook(0, 0);
+    bootSteps.finish();
+
+    if (!found) {
         Serial.println("ITLA not responding!");
+        while (itlaLog.drain(Serial));   // auto-baud attempts
+        bootTrace.report(Serial);
         while (1);
     }
     Serial.println("ITLA connected.");
 
-    // Load saved config
-    loadConfig();
-    Serial.println("Loaded last configuration from EEPROM");
+    if (configLoaded) {
+        Serial.println("Loaded last configuration");
+    } else {
+        Serial.println("No stored configuration, using defaults");
+    }
+
+    // Module capabilities (grid, FCF, ranges): cached per serial number
+    const char *sources[] = { "unavailable", "cached", "known serial", "discovered" };
+    phase = bootTrace.start("profile");
+    Serial.print("Module profile: ");
+    Serial.println(sources[profiles.attach(itla)]);
+    tuneProfiler.attach(itla);
+    bootTrace.end(phase);
 
-    // Apply power & frequency, but keep laser OFF for safety
-    itla.setPower_dBm(savedPower_milli / 1000.0);  // convert milli-dBm to dBm
-    itla.setFrequencyTHz(savedFreq);
-    itla.laserOff();
-    Serial.println("Laser forced OFF at startup for safety.");
+    // Laser must be OFF after a controller restart (safety). Only write RESETA
+    // if the module kept it on, or if we could not tell.
+    phase = bootTrace.start("reconcile");
+    if (itla.isLaserOn() || itla.lastStatus() != 0) {
+        itla.laserOff();
+        Serial.println("Laser forced OFF at startup for safety.");
+    }
+
+    // Reconcile power & frequency with what the module kept across our reboot:
+    // only registers that differ are written, so a matching module is not retuned.
+    uint32_t channel = itla.channelForMHz(savedFreq);
+    uint8_t writes = itla.applyOperatingPoint(channel, savedPower, ITLA_FTF_UNCHANGED);
+    if (writes == 0xFF) {
+        Serial.println("Failed to apply stored configuration");
+    } else if (writes == 0) {
+        Serial.println("Module state matches stored configuration");
+    } else {
+        Serial.print("Reconciled module state (");
+        Serial.print(writes);
+        Serial.println(" register writes)");
+    }
+    bootTrace.end(phase);
+
+    secCommand = loopProfiler.section("command");
+    secSync = loopProfiler.section("sync");
+    secLink = loopProfiler.section("link");
+    secConfig = loopProfiler.section("config");
+    secDrain = loopProfiler.section("drain");
+    loopProfiler.begin();
+
+    bootTrace.ready();
+    bootTrace.report(Serial);
 }
 
 void loop() {
+    loopProfiler.loopStart();
+
     // --- 1. Handle GUI / Serial Commands --- //
     if (Serial.available()) {
+        LOOP_PROBE(secCommand);
         String command = Serial.readStringUntil('\n');
         command.trim();
         processCommand(command);
@@ -76,9 +185,60 @@ void loop() {
     // --- 2. Periodic Sync --- //
     static unsigned long lastSync = 0;
     if (millis() - lastSync > 200) {  // every 200 ms
-        syncITLA();
+        if (itla.linkState() != LINK_LOST) syncITLA();
         lastSync = millis();
     }
+
+    // Background reacquisition if the module went away
+    {
+        LOOP_PROBE(secLink);
+        itla.serviceLink();
+    }
+
+    // --- 3. Deferred config writes --- //
+    {
+        LOOP_PROBE(secConfig);
+        configStore.poll(millis());
+    }
+
+    // --- 4. Driver log and wire trace, only while no command is waiting --- //
+    {
+        LOOP_PROBE(secDrain);
+        if (!Serial.available()) itlaLog.drain(Serial);
+        if (!Serial.available()) itlaTrace.drain(Serial);
+    }
+
+    loopProfiler.loopEnd();
+}
+
+// Split off the next space-separated word of cmd starting at pos
+String nextToken(const String &cmd, int &pos) {
+    while (pos < (int)cmd.length() && cmd.charAt(pos) == ' ') pos++;
+    int start = pos;
+    while (pos < (int)cmd.length() && cmd.charAt(pos) != ' ') pos++;
+    return cmd.substring(start, pos);
+}
+
+void printPreset(uint8_t n) {
+    Preset p;
+    Serial.print(n);
+    Serial.print(": ");
+    if (!presets.get(n, p)) {
+        Serial.println("(empty)");
+        return;
+    }
+    char name[PRESET_NAME_LEN + 1];
+    presets.name(n, name);
+    Serial.print(name);
+    Serial.print(" ");
+    Serial.print(freqToTHz(p.freq), 6);
+    Serial.print(" THz ch ");
+    Serial.print((unsigned long)p.channel);
+    Serial.print(" ");
+    Serial.print(powerToDbm(p.powerRaw), 2);
+    Serial.print(" dBm ftf ");
+    Serial.print(p.ftfRaw);
+    Serial.println(" MHz");
 }
 
 void processCommand(const String &cmd) {
@@ -86,31 +246,32 @@ void processCommand(const String &cmd) {
         itla.laserOn();
         savedLaserEnable = true;
         saveConfig();
-        Serial.println("Laser turned ON (saved to EEPROM)");
+        Serial.println("Laser turned ON (saved)");
 
     } else if (cmd == "LASER_OFF") {
         itla.laserOff();
         savedLaserEnable = false;
         saveConfig();
-        Serial.println("Laser turned OFF (saved to EEPROM)");
+        Serial.println("Laser turned OFF (saved)");
 
     } else if (cmd.startsWith("SET_POWER")) {
-        double power = cmd.substring(10).toDouble(); // dBm
-        itla.setPower_dBm(power);
-        savedPower_milli = (int32_t)(power * 1000);  // store in milli-dBm
+        PowerCdBm power = powerFromDbm(cmd.substring(10).toDouble()); // dBm
+        itla.setPower(power);
+        savedPower = power;
         saveConfig();
         Serial.print("Power set to ");
-        Serial.print(power, 3);
-        Serial.println(" dBm (saved to EEPROM)");
+        Serial.print(powerToDbm(power), 3);
+        Serial.println(" dBm (saved)");
 
     } else if (cmd.startsWith("SET_FREQUENCY")) {
-        double frequency = cmd.substring(14).toDouble();
-        itla.setFrequencyTHz(frequency);
+        // Snapped to the nearest valid channel when the module's plan is known
+        FreqMHz frequency = itla.channelPlan().snap(freqFromTHz(cmd.substring(14).toDouble()));
+        itla.setFrequencyMHz(frequency);
         savedFreq = frequency;
         saveConfig();
         Serial.print("Frequency set to ");
-        Serial.print(frequency, 6);
-        Serial.println(" THz (saved to EEPROM)");
+        Serial.print(freqToTHz(frequency), 6);
+        Serial.println(" THz (saved)");
 
     } else if (cmd == "GET_TEMPERATURE") {
         double tempC = itla.getTemperature();
@@ -124,12 +285,165 @@ void processCommand(const String &cmd) {
         Serial.print(freq, 6);
         Serial.println(" THz");
 
+    } else if (cmd.startsWith("SET_CHANNEL")) {
+        // SET_CHANNEL <n>: address the laser by channel index; the tune is
+        // timed and fed to the settle-time map
+        uint32_t channel = (uint32_t)cmd.substring(12).toInt();
+        TuneResult r;
+        if (!tuneProfiler.tune(itla, channel, r)) {
+            Serial.println("Channel rejected");
+            return;
+        }
+        const ChannelPlan &plan = itla.channelPlan();
+        if (plan.valid()) savedFreq = plan.frequency(channel);
+        saveConfig();
+        Serial.print("Channel set to ");
+        Serial.print((unsigned long)channel);
+        Serial.print(" (saved), pending ");
+        Serial.print(r.pendingMs);
+        if (r.settled) {
+            Serial.print(" ms, settled ");
+            Serial.print(r.settleMs);
+            Serial.print(" ms, error ");
+            Serial.print(r.errorMHz);
+            Serial.println(" MHz");
+        } else {
+            Serial.println(" ms, not settled");
+        }
+
+    } else if (cmd.startsWith("GET_SETTLE")) {
+        // GET_SETTLE <n>: expected settle time from the current channel to n,
+        // for automation that would otherwise sleep a fixed worst case
+        uint32_t channel = (uint32_t)cmd.substring(11).toInt();
+        Serial.print("Settle estimate: ");
+        Serial.print(tuneProfiler.settleEstimateMs(itla.getChannel(), channel));
+        Serial.println(" ms");
+
+    } else if (cmd == "TUNE_STATS") {
+        // One line per measured band pair: from->to settle/baseline/max ms
+        Serial.print("Window +/-");
+        Serial.print(tuneProfiler.windowMHz());
+        Serial.println(" MHz");
+        for (uint8_t i = 0; i < TUNE_BANDS; i++) {
+            for (uint8_t j = 0; j < TUNE_BANDS; j++) {
+                const TuneCell &c = tuneProfiler.cell(i, j);
+                if (c.count == 0) continue;
+                Serial.print(i); Serial.print("->"); Serial.print(j);
+                Serial.print(" n="); Serial.print(c.count);
+                Serial.print(" pending="); Serial.print(c.pendingMs);
+                Serial.print(" settle="); Serial.print(c.settleMs);
+                Serial.print(" baseline="); Serial.print(c.baselineMs);
+                Serial.print(" max="); Serial.print(c.maxMs);
+                Serial.println(tuneProfiler.slowing(i, j) ? " SLOWING" : "");
+            }
+        }
+
+    } else if (cmd == "GET_CHANNEL") {
+        Serial.print("Channel: ");
+        Serial.println((unsigned long)itla.getChannel());
+
+    } else if (cmd == "GET_CHANNEL_PLAN") {
+        const ChannelPlan &plan = itla.channelPlan();
+        if (!plan.valid()) {
+            Serial.println("No channel plan (module profile unavailable)");
+            return;
+        }
+        Serial.print("Channels ");
+        Serial.print((unsigned long)plan.firstChannel());
+        Serial.print("-");
+        Serial.print((unsigned long)plan.lastChannel());
+        Serial.print(", grid ");
+        Serial.print(plan.gridMHz() / 1000.0, 3);
+        Serial.print(" GHz, ");
+        Serial.print(freqToTHz(plan.frequency(plan.firstChannel())), 6);
+        Serial.print("-");
+        Serial.print(freqToTHz(plan.frequency(plan.lastChannel())), 6);
+        Serial.println(" THz");
+
     } else if (cmd == "GET_POWER") {
         double power = itla.getPower_dBm();
         Serial.print("Power: ");
         Serial.print(power, 3);
         Serial.println(" dBm");
 
+    } else if (cmd.startsWith("RECALL")) {
+        // RECALL <n>
+        int n = cmd.substring(7).toInt();
+        Preset p;
+        if (!presets.get(n, p)) {
+            Serial.println("Preset empty");
+            return;
+        }
+        uint8_t writes = presets.recall(itla, n);
+        if (writes == 0xFF) {
+            Serial.println("Preset recall failed");
+            return;
+        }
+        savedFreq = p.freq;
+        savedPower = p.powerRaw;
+        saveConfig();
+        Serial.print("Preset ");
+        Serial.print(n);
+        Serial.print(" applied (");
+        Serial.print(writes);
+        Serial.println(" register writes)");
+
+    } else if (cmd.startsWith("SAVE_PRESET")) {
+        // SAVE_PRESET <n> <name> <freq THz> <power dBm> [ftf MHz]
+        int pos = 11;
+        int n = nextToken(cmd, pos).toInt();
+        String name = nextToken(cmd, pos);
+        FreqMHz frequency = freqFromTHz(nextToken(cmd, pos).toDouble());
+        PowerCdBm power = powerFromDbm(nextToken(cmd, pos).toDouble());
+        int ftf = nextToken(cmd, pos).toInt();
+        if (presets.save(itla, n, name.c_str(), frequency, power, ftf)) {
+            printPreset(n);
+        } else {
+            Serial.println("Preset not saved");
+        }
+
+    } else if (cmd == "LIST_PRESETS") {
+        for (uint8_t n = 0; n < PRESET_COUNT; n++) printPreset(n);
+
+    } else if (cmd == "SNAPSHOT") {
+        // Full register capture in one pass; kept for SNAPSHOT_DIFF
+        snapshots.take(itla, lastSnapshot);
+        haveSnapshot = true;
+        printSnapshot(lastSnapshot, Serial);
+
+    } else if (cmd == "SNAPSHOT_DIFF") {
+        // New capture, print what changed since the previous one
+        Snapshot now;
+        snapshots.take(itla, now);
+        if (haveSnapshot) {
+            diffSnapshots(lastSnapshot, now, Serial);
+        } else {
+            printSnapshot(now, Serial);
+        }
+        lastSnapshot = now;
+        haveSnapshot = true;
+
+    } else if (cmd == "TRACE_ON") {
+        // Wire trace to the console as '%' lines; itla_trace convert makes a file
+        itlaTrace.start(micros());
+        Serial.println("Trace on");
+
+    } else if (cmd == "TRACE_OFF") {
+        itlaTrace.stop();
+        Serial.print("Trace off, records dropped: ");
+        Serial.println(itlaTrace.dropped());
+
+    } else if (cmd == "PROFILE") {
+        // loop() timing since boot or PROFILE_RESET; this pass includes the print
+        loopProfiler.report(Serial);
+
+    } else if (cmd == "PROFILE_RESET") {
+        loopProfiler.reset();
+        Serial.println("Profile reset");
+
+    } else if (cmd == "BOOT_TIMELINE") {
+        bootTrace.report(Serial);
+
     } else if (cmd == "GET_MANUFACTURER") {
         String manuf = itla.readAEAString(ITLA_REG_MANUF);
         Serial.print("Manufacturer: ");
@@ -0,0 +1,51 @@
+// File: host/Adafruit_GFX.h
+// The part of Adafruit GFX the OLED sketch uses, for host builds: text with
+// the classic 5x7 font in 6x8 cells (scaled by setTextSize(), wrapped at the
+// right edge, transparent background unless setTextColor(fg, bg)) and a few
+// primitives, all on a subclass's drawPixel(). Cursor and wrap rules follow
+// the library, so a screen lays out as it does on the panel; glyph shapes
+// are this file's own font, close to but not pixel-exact with the library's.
+#ifndef ADAFRUIT_GFX_H
+#define ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextSize(uint8_t s) { textSize = s ? s : 1; }
+    void setTextColor(uint16_t c) { textColor = textBg = c; }   // bg == fg: transparent
+    void setTextColor(uint16_t c, uint16_t bg) { textColor = c; textBg = bg; }
+    void setTextWrap(bool w) { wrap = w; }
+
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+    int16_t width() const { return w; }
+    int16_t height() const { return h; }
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+
+    uint64_t glyphsDrawn() const { return glyphs; }
+
+protected:
+    const int16_t w, h;
+    int16_t cursorX, cursorY;
+    uint16_t textColor, textBg;
+    uint8_t textSize;
+    bool wrap;
+    uint64_t glyphs;
+};
+
+#endif // ADAFRUIT_GFX_H
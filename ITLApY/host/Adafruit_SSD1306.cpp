@@ -0,0 +1,171 @@
+// File: host/Adafruit_SSD1306.cpp
+#include "Adafruit_SSD1306.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *, int8_t, uint32_t clkDuring, uint32_t)
+    : Adafruit_GFX(w, h), clockHz(clkDuring), buffer(0), glass(0), frameBytes((size_t)w * ((h + 7) / 8)),
+      glyphsBase(0), renderStartNs(0), busTiming(false) {
+    resetStats();
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    free(buffer);
+    free(glass);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t, bool, bool) {
+    if (!buffer) buffer = (uint8_t *)calloc(frameBytes, 1);
+    if (!glass) glass = (uint8_t *)calloc(frameBytes, 1);
+    if (!buffer || !glass) return false;
+    memset(buffer, 0, frameBytes);
+    return true;
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    if (!buffer) return;
+    memset(buffer, 0, frameBytes);
+    st.clears++;
+    renderStartNs = monotonicNs();
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!buffer || x < 0 || x >= w || y < 0 || y >= h) return;
+    uint8_t &b = buffer[x + (y / 8) * w];
+    uint8_t bit = (uint8_t)(1 << (y & 7));
+    uint8_t was = b;
+    switch (color) {
+    case SSD1306_WHITE:   b |= bit; break;
+    case SSD1306_BLACK:   b &= (uint8_t)~bit; break;
+    case SSD1306_INVERSE: b ^= bit; break;
+    }
+    st.pixelsTouched++;
+    if (b != was) st.pixelsChanged++;
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+    if (!buffer || x < 0 || x >= w || y < 0 || y >= h) return false;
+    return (buffer[x + (y / 8) * w] >> (y & 7)) & 1;
+}
+
+bool Adafruit_SSD1306::glassPixel(int16_t x, int16_t y) const {
+    if (!glass || x < 0 || x >= w || y < 0 || y >= h) return false;
+    return (glass[x + (y / 8) * w] >> (y & 7)) & 1;
+}
+
+void Adafruit_SSD1306::display() {
+    if (!buffer) return;
+    // PAGEADDR 0..0xFF, COLUMNADDR 0 as one command list, then the last column
+    uint64_t bytes = (1 + 1 + 5) + (1 + 1 + 1);
+    uint64_t transactions = 2;
+    // Data: 0x40 then up to WIRE_MAX - 1 bytes per transaction
+    uint64_t chunks = (frameBytes + WIRE_MAX - 2) / (WIRE_MAX - 1);
+    bytes += frameBytes + 2 * chunks;
+    transactions += chunks;
+    st.busBytes += bytes;
+    st.transactions += transactions;
+
+    for (size_t i = 0; i < frameBytes; i++) {
+        if (buffer[i] != glass[i]) st.dirtyBytes++;
+    }
+    memcpy(glass, buffer, frameBytes);
+    st.frames++;
+    if (renderStartNs) {
+        st.renderNs += monotonicNs() - renderStartNs;
+        renderStartNs = 0;
+    }
+    if (busTiming) delayMicroseconds((unsigned int)busUs(bytes, transactions));
+}
+
+FramebufferStats Adafruit_SSD1306::stats() const {
+    FramebufferStats s = st;
+    s.glyphs = glyphsDrawn() - glyphsBase;
+    return s;
+}
+
+void Adafruit_SSD1306::resetStats() {
+    memset(&st, 0, sizeof(st));
+    glyphsBase = glyphsDrawn();
+}
+
+uint64_t Adafruit_SSD1306::busUs(uint64_t bytes, uint64_t transactions) const {
+    // 8 data bits + ACK per byte, about one clock each for START and STOP
+    uint64_t clocks = bytes * 9 + transactions * 2;
+    return clocks * 1000000ULL / clockHz;
+}
+
+// ---------- PBM ----------
+
+bool Adafruit_SSD1306::writePbm(FILE *f) const {
+    if (!glass) return false;
+    fprintf(f, "P4\n%d %d\n", w, h);
+    size_t rowBytes = (size_t)(w + 7) / 8;
+    uint8_t row[64];
+    for (int16_t y = 0; y < h; y++) {
+        memset(row, 0, rowBytes);
+        for (int16_t x = 0; x < w; x++) {
+            if (glassPixel(x, y)) row[x / 8] |= (uint8_t)(0x80 >> (x & 7));
+        }
+        if (fwrite(row, 1, rowBytes, f) != rowBytes) return false;
+    }
+    return true;
+}
+
+bool Adafruit_SSD1306::savePbm(const char *path) const {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = writePbm(f);
+    return fclose(f) == 0 && ok;
+}
+
+// Next header number, skipping whitespace and # comments
+static long pbmNumber(FILE *f) {
+    int c;
+    for (;;) {
+        c = fgetc(f);
+        if (c == '#') {
+            while (c != '\n' && c != EOF) c = fgetc(f);
+        } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            break;
+        }
+    }
+    long v = -1;
+    while (c >= '0' && c <= '9') {
+        v = (v < 0 ? 0 : v * 10) + (c - '0');
+        c = fgetc(f);
+    }
+    return v;   // the one whitespace after the number is consumed
+}
+
+int Adafruit_SSD1306::comparePbm(const char *path) const {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    int differ = -1;
+    if (fgetc(f) == 'P' && fgetc(f) == '4' && pbmNumber(f) == w && pbmNumber(f) == h && glass) {
+        size_t rowBytes = (size_t)(w + 7) / 8;
+        uint8_t row[64];
+        differ = 0;
+        for (int16_t y = 0; y < h; y++) {
+            if (fread(row, 1, rowBytes, f) != rowBytes) {
+                differ = -1;
+                break;
+            }
+            for (int16_t x = 0; x < w; x++) {
+                if (((row[x / 8] >> (7 - (x & 7))) & 1) != glassPixel(x, y)) {
+                    differ++;
+                    break;
+                }
+            }
+        }
+    }
+    fclose(f);
+    return differ;
+}
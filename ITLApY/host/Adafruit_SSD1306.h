@@ -0,0 +1,86 @@
+// File: host/Adafruit_SSD1306.h
+// In-memory SSD1306 for host builds of the OLED sketch. Drawing goes to a
+// RAM buffer in the controller's layout (pages of eight rows, one byte per
+// column); display() copies it to the "glass", the frame a PBM dump or a
+// golden-image check sees, and counts what the real flush would cost:
+//   pixelsTouched  in-bounds drawPixel() writes (fillRect, text... included)
+//   pixelsChanged  of those, writes that flipped a bit
+//   busBytes       I2C bytes of the flushes as the library sends them: the
+//                  address window commands, then the frame in transactions
+//                  of address, control byte and up to 31 data bytes
+//   dirtyBytes     frame bytes that differ from the previous flush, what a
+//                  flush of only the changed columns would have to send
+//   renderNs       host time from clearDisplay() to display()
+// busUs() turns busBytes into bus time at the I2C clock given to the
+// constructor (9 clocks per byte plus start/stop per transaction); with
+// setBusTiming(true) display() also takes that long (delayMicroseconds), so
+// a sketch run on simulated time sees the flush as it would on the Due.
+#ifndef ADAFRUIT_SSD1306_H
+#define ADAFRUIT_SSD1306_H
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "Adafruit_GFX.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+struct FramebufferStats {
+    uint64_t frames;          // display() calls
+    uint64_t clears;
+    uint64_t pixelsTouched;
+    uint64_t pixelsChanged;
+    uint64_t glyphs;          // characters drawn
+    uint64_t busBytes;
+    uint64_t transactions;    // I2C transactions of the flushes
+    uint64_t dirtyBytes;
+    uint64_t renderNs;
+};
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    static const uint8_t WIRE_MAX = 32;   // bytes per I2C transaction, address included
+
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi = &Wire, int8_t rstPin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0, bool reset = true, bool periphBegin = true);
+    void clearDisplay();
+    void display();
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y) const;
+    uint8_t *getBuffer() { return buffer; }
+
+    // The panel as of the last display(): pixel, whole frame as PBM (P4,
+    // lit pixels black)
+    bool glassPixel(int16_t x, int16_t y) const;
+    bool writePbm(FILE *f) const;
+    bool savePbm(const char *path) const;
+    // Pixel rows of the glass that differ from a PBM file; -1 if the file
+    // cannot be read or is not a P4 image of the panel's size
+    int comparePbm(const char *path) const;
+
+    FramebufferStats stats() const;
+    void resetStats();
+    uint64_t busUs(uint64_t bytes, uint64_t transactions) const;
+    void setBusTiming(bool on) { busTiming = on; }
+
+private:
+    uint32_t clockHz;
+    uint8_t *buffer;
+    uint8_t *glass;
+    size_t frameBytes;
+    FramebufferStats st;
+    uint64_t glyphsBase;
+    uint64_t renderStartNs;
+    bool busTiming;
+};
+
+#endif // ADAFRUIT_SSD1306_H
@@ -0,0 +1,272 @@
+// File: host/Arduino.cpp
+#include "Arduino.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---------- Time ----------
+
+static uint64_t monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static const uint64_t startUs = monotonicUs();
+static HostTime *hostTime = nullptr;
+
+void hostUseTime(HostTime *t) {
+    hostTime = t;
+}
+
+unsigned long millis() {
+    if (hostTime) return (unsigned long)(hostTime->nowUs() / 1000);
+    return (unsigned long)((monotonicUs() - startUs) / 1000);
+}
+
+unsigned long micros() {
+    if (hostTime) return (unsigned long)hostTime->nowUs();
+    return (unsigned long)(monotonicUs() - startUs);
+}
+
+void delay(unsigned long ms) {
+    if (hostTime) return hostTime->sleepUs((uint64_t)ms * 1000);
+    struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (hostTime) return hostTime->sleepUs(us);
+    struct timespec ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+// ---------- Pins ----------
+
+static uint8_t pinLevel[HOST_PINS];
+static void (*pinIsr[HOST_PINS])();
+static int pinIsrMode[HOST_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HOST_PINS && mode == INPUT_PULLUP) pinLevel[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PINS ? pinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < HOST_PINS) pinLevel[pin] = level ? HIGH : LOW;
+}
+
+void attachInterrupt(int irq, void (*isr)(), int mode) {
+    if (irq < 0 || irq >= HOST_PINS) return;
+    pinIsr[irq] = isr;
+    pinIsrMode[irq] = mode;
+}
+
+void detachInterrupt(int irq) {
+    if (irq >= 0 && irq < HOST_PINS) pinIsr[irq] = nullptr;
+}
+
+void hostDriveInput(uint8_t pin, int level) {
+    if (pin >= HOST_PINS) return;
+    uint8_t was = pinLevel[pin];
+    pinLevel[pin] = level ? HIGH : LOW;
+    if (was == pinLevel[pin] || !pinIsr[pin]) return;
+    int mode = pinIsrMode[pin];
+    if (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)) pinIsr[pin]();
+}
+
+// ---------- String ----------
+
+void String::trim() {
+    size_t b = str.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) {
+        str.clear();
+        return;
+    }
+    size_t e = str.find_last_not_of(" \t\r\n");
+    str = str.substr(b, e - b + 1);
+}
+
+// ---------- Print / Stream ----------
+
+size_t Print::write(const uint8_t *buf, size_t len) {
+    size_t n = 0;
+    while (n < len && write(buf[n])) n++;
+    return n;
+}
+
+size_t Print::print(unsigned long long v, int base) {
+    char buf[65];
+    char *p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    if (base < 2) base = DEC;
+    do {
+        int d = (int)(v % base);
+        *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+        v /= base;
+    } while (v);
+    return write(p);
+}
+
+size_t Print::print(long long v, int base) {
+    // Arduino prints negative numbers signed only in decimal
+    if (base == DEC && v < 0) return print('-') + print((unsigned long long)(-(v + 1)) + 1, base);
+    return print((unsigned long long)v, base);
+}
+
+size_t Print::print(long v, int base) {
+    if (base != DEC && v < 0) return print((unsigned long long)(unsigned long)v, base);
+    return print((long long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+    return print((unsigned long long)v, base);
+}
+
+size_t Print::print(double v, int digits) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return write(buf);
+}
+
+String Stream::readStringUntil(char terminator) {
+    String s;
+    unsigned long t0 = millis();
+    while (millis() - t0 < timeoutMs) {
+        int c = read();
+        if (c < 0) {
+            delay(1);
+            continue;
+        }
+        if (c == terminator) break;
+        s += (char)c;
+        t0 = millis();
+    }
+    return s;
+}
+
+// ---------- HardwareSerial ----------
+
+HardwareSerial Serial;
+HardwareSerial Serial1(nullptr);
+
+HardwareSerial::HardwareSerial() : console(true), rxFd(0), txFd(1), rxHead(0), rxTail(0) {
+}
+
+HardwareSerial::HardwareSerial(const char *p) : path(p ? p : ""), console(false), rxFd(-1), txFd(-1), rxHead(0), rxTail(0) {
+}
+
+HardwareSerial::~HardwareSerial() {
+    if (!console) end();
+}
+
+static speed_t baudConstant(unsigned long baud) {
+    switch (baud) {
+        case 4800:   return B4800;
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 230400: return B230400;
+        case 115200:
+        default:     return B115200;
+    }
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+    if (device) return device->begin(baud);
+    if (console) return;
+    if (rxFd < 0) {
+        if (path.empty()) {
+            const char *env = getenv("ITLA_PORT");
+            path = env ? env : "/dev/ttyUSB0";
+        }
+        rxFd = txFd = open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (rxFd < 0) {
+            fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+            return;
+        }
+    }
+
+    // 8N1 raw; ptys and pipes simply ignore this
+    struct termios tio;
+    if (tcgetattr(rxFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        cfsetispeed(&tio, baudConstant(baud));
+        cfsetospeed(&tio, baudConstant(baud));
+        tcsetattr(rxFd, TCSANOW, &tio);
+        tcflush(rxFd, TCIOFLUSH);
+    }
+    rxHead = rxTail = 0;
+}
+
+void HardwareSerial::end() {
+    if (console || rxFd < 0) return;
+    close(rxFd);
+    rxFd = txFd = -1;
+}
+
+void HardwareSerial::fill() {
+    if (rxFd < 0) return;
+    if (rxHead == rxTail) rxHead = rxTail = 0;
+    if (rxTail == sizeof(rx)) return;
+    if (console) {
+        // stdin is blocking; only read what is there
+        struct pollfd pfd = { rxFd, POLLIN, 0 };
+        if (poll(&pfd, 1, 0) <= 0) return;
+    }
+    ssize_t n = ::read(rxFd, rx + rxTail, sizeof(rx) - rxTail);
+    if (n > 0) rxTail += (size_t)n;
+}
+
+int HardwareSerial::available() {
+    if (device) return device->available();
+    if (rxHead == rxTail) fill();
+    return (int)(rxTail - rxHead);
+}
+
+int HardwareSerial::read() {
+    if (device) return device->read();
+    if (available() == 0) return -1;
+    return rx[rxHead++];
+}
+
+int HardwareSerial::peek() {
+    if (device) return -1;
+    if (available() == 0) return -1;
+    return rx[rxHead];
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t len) {
+    if (device) return device->write(buf, len);
+    if (txFd < 0) return 0;
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = ::write(txFd, buf + done, len - done);
+        if (n > 0) {
+            done += (size_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            struct pollfd pfd = { txFd, POLLOUT, 0 };
+            poll(&pfd, 1, 10);
+        } else {
+            break;
+        }
+    }
+    return done;
+}
+
+void HardwareSerial::flush() {
+    if (device) return;
+    if (console) fflush(stdout);
+    else if (txFd >= 0) tcdrain(txFd);
+}
@@ -0,0 +1,190 @@
+// File: host/Arduino.h
+// Minimal Arduino core for building the ITLA driver on Linux hosts.
+// Serial is the console (stdin/stdout); Serial1 and any other HardwareSerial
+// is a tty opened raw through termios. Only what the driver and the host
+// tools use is provided.
+//
+// A tool can also run a whole sketch off the hardware: hostUseTime() moves
+// millis()/micros()/delay() onto its own (e.g. simulated) time, a
+// HardwareSerial attached to a SerialDevice talks to that device instead of a
+// tty, and hostDriveInput() changes an input pin's level, running the
+// interrupt handler attached to it as the hardware would.
+//
+// Build the driver for a host tool with:
+//   g++ -std=c++20 -O2 -pthread -Ihost -I. host/Arduino.cpp ITLA_.cpp
+//       ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp <tool sources>
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define HEX 16
+#define DEC 10
+#define F(x) (x)
+#define PROGMEM
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define HOST_PINS 64
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Time source for the calls above; null (the default) is the monotonic clock
+class HostTime {
+public:
+    virtual ~HostTime() {}
+    virtual uint64_t nowUs() = 0;          // may move time on, as one poll would
+    virtual void sleepUs(uint64_t us) = 0;
+};
+void hostUseTime(HostTime *t);
+
+// Pins, with interrupt numbers equal to pin numbers as on the Due
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int irq, void (*isr)(), int mode);
+void detachInterrupt(int irq);
+inline void noInterrupts() {}
+inline void interrupts() {}
+// Sets an input's level from outside (a button, a test); runs its handler
+void hostDriveInput(uint8_t pin, int level);
+
+class String {
+public:
+    String(const char *s = "") : str(s ? s : "") {}
+    String(const std::string &s) : str(s) {}
+    explicit String(char c) : str(1, c) {}
+    explicit String(long v) : str(std::to_string(v)) {}
+
+    unsigned int length() const { return (unsigned int)str.size(); }
+    const char *c_str() const { return str.c_str(); }
+    char charAt(unsigned int i) const { return i < str.size() ? str[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    String &operator+=(char c) { str += c; return *this; }
+    String &operator+=(const char *s) { str += s; return *this; }
+    String &operator+=(const String &s) { str += s.str; return *this; }
+    bool operator==(const String &s) const { return str == s.str; }
+    bool operator==(const char *s) const { return str == s; }
+    bool operator!=(const String &s) const { return str != s.str; }
+
+    String substring(unsigned int from) const { return from < str.size() ? String(str.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from >= str.size() || to <= from) return String();
+        return String(str.substr(from, to - from));
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t p = str.find(c, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    bool startsWith(const String &prefix) const { return str.compare(0, prefix.str.size(), prefix.str) == 0; }
+    void trim();
+    long toInt() const { return strtol(str.c_str(), 0, 10); }
+    double toDouble() const { return strtod(str.c_str(), 0); }
+    void reserve(unsigned int n) { str.reserve(n); }
+
+private:
+    std::string str;
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buf, size_t len);
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC);
+    size_t print(unsigned long v, int base = DEC);
+    size_t print(long long v, int base = DEC);
+    size_t print(unsigned long long v, int base = DEC);
+    size_t print(double v, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(T v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    String readStringUntil(char terminator);
+    void setTimeout(unsigned long ms) { timeoutMs = ms; }
+
+protected:
+    unsigned long timeoutMs = 1000;
+};
+
+// Stands in for the far end of a HardwareSerial (see HardwareSerial::attach)
+class SerialDevice {
+public:
+    virtual ~SerialDevice() {}
+    virtual void begin(unsigned long baud) = 0;
+    virtual size_t write(const uint8_t *buf, size_t len) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+};
+
+class HardwareSerial : public Stream {
+public:
+    // Console (stdin/stdout)
+    HardwareSerial();
+    // tty device; a null path is taken from $ITLA_PORT (default /dev/ttyUSB0) at begin()
+    explicit HardwareSerial(const char *path);
+    ~HardwareSerial();
+
+    void begin(unsigned long baud);
+    void end();
+    int available() override;
+    int read() override;
+    int peek();
+    using Print::write;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t len) override;
+    void flush();
+    int fd() const { return rxFd; }   // for poll()/epoll based hosts
+    operator bool() const { return true; }
+    // Route everything through dev instead of the console or tty (null: back)
+    void attach(SerialDevice *dev) { device = dev; }
+
+private:
+    SerialDevice *device = nullptr;
+    std::string path;
+    bool console;
+    int rxFd, txFd;
+    uint8_t rx[256];
+    size_t rxHead, rxTail;
+
+    void fill();
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif // ARDUINO_H
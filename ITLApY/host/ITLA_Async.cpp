@@ -0,0 +1,212 @@
+// File: host/ITLA_Async.cpp
+#include "ITLA_Async.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---------- EpollExecutor ----------
+
+EpollExecutor::EpollExecutor() : epfd(epoll_create1(EPOLL_CLOEXEC)) {
+}
+
+EpollExecutor::~EpollExecutor() {
+    if (epfd >= 0) close(epfd);
+}
+
+uint64_t EpollExecutor::nowUs() const {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+EpollExecutor::TimerId EpollExecutor::addTimer(uint64_t deadlineUs, std::function<void()> fn) {
+    return timers.emplace(deadlineUs, std::move(fn));
+}
+
+bool EpollExecutor::watch(int fd, IoWatcher *w) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = w;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+void EpollExecutor::unwatch(int fd) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void EpollExecutor::spawn(Task<void> t) {
+    post(t.handle());
+    roots.push_back(std::move(t));
+}
+
+void EpollExecutor::run() {
+    struct epoll_event events[32];
+    for (;;) {
+        while (!ready.empty()) {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            h.resume();
+        }
+
+        // Reap finished procedures
+        for (size_t i = 0; i < roots.size();) {
+            if (roots[i].handle().done()) {
+                Task<void> t = std::move(roots[i]);
+                roots.erase(roots.begin() + i);
+                t.await_resume();   // rethrows
+            } else {
+                i++;
+            }
+        }
+        if (roots.empty()) return;
+
+        // Sleep until I/O or the next timer
+        int timeoutMs = -1;
+        if (!timers.empty()) {
+            uint64_t now = nowUs();
+            uint64_t next = timers.begin()->first;
+            timeoutMs = next <= now ? 0 : (int)((next - now + 999) / 1000);
+        }
+        int n = epoll_wait(epfd, events, 32, timeoutMs);
+        if (n < 0 && errno != EINTR) return;
+        for (int i = 0; i < n; i++) static_cast<IoWatcher *>(events[i].data.ptr)->onReadable();
+
+        uint64_t now = nowUs();
+        while (!timers.empty() && timers.begin()->first <= now) {
+            std::function<void()> fn = std::move(timers.begin()->second);
+            timers.erase(timers.begin());
+            fn();
+        }
+    }
+}
+
+// ---------- AsyncITLA ----------
+
+static const long ASYNC_BAUDS[] = {4800, 9600, 19200, 38400, 57600, 115200};
+
+AsyncITLA::AsyncITLA(EpollExecutor &ex, const char *p)
+    : ex(ex), path(p), serial(p), baudRate(0), current(nullptr), timerLive(false), txCount(0) {
+    setBaud(9600);
+    if (serial.fd() >= 0) ex.watch(serial.fd(), this);
+}
+
+AsyncITLA::~AsyncITLA() {
+    if (timerLive) ex.cancelTimer(timeout);
+    if (serial.fd() >= 0) ex.unwatch(serial.fd());
+}
+
+void AsyncITLA::setBaud(long baud) {
+    baudRate = baud;
+    serial.begin(baud);
+    rx.reset();
+}
+
+AsyncITLA::TxAwaiter AsyncITLA::transact(uint8_t reg, bool write, uint16_t data) {
+    TxAwaiter tx{ *this, {}, LinkReply{ 0, 0xFF, ITLA_ERR_OK }, {} };
+    itlaEncode(tx.frame, reg, write, data);
+    return tx;
+}
+
+void AsyncITLA::enqueue(TxAwaiter *tx) {
+    waiting.push_back(tx);
+    if (!current) startNext();
+}
+
+void AsyncITLA::startNext() {
+    while (!current && !waiting.empty()) {
+        TxAwaiter *tx = waiting.front();
+        waiting.pop_front();
+        if (serial.fd() < 0) {
+            ex.post(tx->h);   // port never opened: fails with status 0xFF
+            continue;
+        }
+        // Whatever is left from a timed-out exchange would misalign this one
+        uint8_t junk[64];
+        while (::read(serial.fd(), junk, sizeof(junk)) > 0) {}
+        current = tx;
+        rx.reset(tx->frame[1]);
+        serial.write(tx->frame, ITLA_FRAME_LEN);
+        // Two frames on the wire (10 bits per byte) plus module turnaround
+        uint64_t frameUs = 2 * 40ULL * 1000000ULL / baudRate;
+        timeout = ex.addTimer(ex.nowUs() + frameUs + RESPONSE_TIMEOUT_MS * 1000ULL,
+                              [this] { timerLive = false; complete(0xFF, 0); });
+        timerLive = true;
+    }
+}
+
+void AsyncITLA::complete(uint8_t status, uint16_t data) {
+    TxAwaiter *tx = current;
+    if (!tx) return;
+    if (timerLive) ex.cancelTimer(timeout);
+    timerLive = false;
+    current = nullptr;
+    tx->result = LinkReply{ data, status, ITLA_ERR_OK };
+    txCount++;
+    ex.post(tx->h);
+    startNext();
+}
+
+void AsyncITLA::onReadable() {
+    uint8_t buf[64];
+    ssize_t n;
+    while ((n = ::read(serial.fd(), buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (!current) continue;   // late reply to a timed-out frame
+            // Noise is skipped by the assembler; a lost byte ends in the timeout
+            if (!rx.feed(buf[i])) continue;
+            ITLAResponse r;
+            itlaDecode(rx.frame(), r);
+            if (r.ce) complete(0xFE, 0);
+            else complete(r.status, r.data);
+        }
+    }
+}
+
+Task<LinkReply> AsyncITLA::readRaw(uint8_t reg) {
+    LinkReply r = co_await transact(reg, false, 0);
+    if (r.status == ITLA_ST_XE) {
+        LinkReply nop = co_await transact(ITLA_REG_NOP, false, 0);
+        r.error = nop.value & 0x0F;
+    }
+    co_return r;
+}
+
+Task<LinkReply> AsyncITLA::writeRaw(uint8_t reg, uint16_t value) {
+    LinkReply r = co_await transact(reg, true, value);
+    if (r.status == ITLA_ST_XE) {
+        LinkReply nop = co_await transact(ITLA_REG_NOP, false, 0);
+        r.error = nop.value & 0x0F;
+    }
+    co_return r;
+}
+
+Task<bool> AsyncITLA::begin() {
+    for (long b : ASYNC_BAUDS) {
+        setBaud(b);
+        co_await ex.sleep(50);
+        LinkReply r = co_await transact(ITLA_REG_NOP, false, 0);
+        if (r.status == ITLA_ST_OK) co_return true;
+    }
+    setBaud(9600);
+    co_return false;
+}
+
+Task<bool> AsyncITLA::waitPending(uint32_t timeoutMs) {
+    uint64_t deadline = ex.nowUs() + timeoutMs * 1000ULL;
+    for (;;) {
+        LinkReply nop = co_await transact(ITLA_REG_NOP, false, 0);
+        if (nop.status == ITLA_ST_OK && (nop.value >> 8) == 0) co_return true;
+        if (ex.nowUs() >= deadline) co_return false;
+        co_await ex.sleep(PENDING_POLL_MS);
+    }
+}
+
+Task<bool> AsyncITLA::tune(uint32_t channel) {
+    LinkReply r = co_await writeRaw(ITLA_REG_CHANNELH, (uint16_t)(channel >> 16));
+    if (r.status != ITLA_ST_OK) co_return false;
+    r = co_await writeRaw(ITLA_REG_CHANNEL, (uint16_t)channel);
+    if (r.status != ITLA_ST_OK) co_return false;
+    co_return co_await waitPending();
+}
@@ -0,0 +1,234 @@
+// File: host/ITLA_Async.h
+// Coroutine front end for host-side automation. One EpollExecutor thread
+// drives any number of ports; each AsyncITLA keeps one frame in flight and
+// queues the rest, so procedures read like blocking code without tying up a
+// thread per laser:
+//
+//   Task<void> sweep(AsyncITLA &itla) {
+//       if (!co_await itla.begin()) co_return;
+//       for (uint32_t ch = 1; ch <= 10; ch++) {
+//           if (!co_await itla.tune(ch)) break;
+//           LinkReply t = co_await itla.read(Reg::Temp);
+//       }
+//   }
+//   EpollExecutor ex;  AsyncITLA a(ex, "/dev/ttyUSB0");
+//   ex.spawn(sweep(a));  ex.run();
+//
+// Build (from ITLApY/): add host/ITLA_Async.cpp to the LinkService build line, -std=c++20.
+#ifndef ITLA_ASYNC_H
+#define ITLA_ASYNC_H
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ITLA_Frame.h"
+#include "ITLA_LinkService.h"   // LinkReply
+
+// Register names for the coroutine API
+enum class Reg : uint8_t {
+    Nop = ITLA_REG_NOP, DevType = ITLA_REG_DEV_TYPE, Manuf = ITLA_REG_MANUF, Model = ITLA_REG_MODEL,
+    SerialNo = ITLA_REG_SN, StatusF = ITLA_REG_STATUSF, StatusW = ITLA_REG_STATUSW,
+    FFreqTh = ITLA_REG_FFREQTH, WFreqTh = ITLA_REG_WFREQTH,
+    Channel = ITLA_REG_CHANNEL, Power = ITLA_REG_POWER, ResetA = ITLA_REG_RESETA, Grid = ITLA_REG_GRID,
+    Fcf1 = ITLA_REG_FCF1, Fcf2 = ITLA_REG_FCF2, LF1 = ITLA_REG_LF1, LF2 = ITLA_REG_LF2,
+    Oop = ITLA_REG_OOP, Temp = ITLA_REG_TEMP, Ftf = ITLA_REG_FTF, Grid2 = ITLA_REG_GRID2,
+    Fcf3 = ITLA_REG_FCF3, LF3 = ITLA_REG_LF3, FFreqTh2 = ITLA_REG_FFREQTH2, WFreqTh2 = ITLA_REG_WFREQTH2,
+    ChannelH = ITLA_REG_CHANNELH
+};
+
+// ---------- Task<T> ----------
+
+template <typename T> class Task;
+
+namespace itla_detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Resume whoever awaited this task (symmetric transfer, no stack growth)
+    struct Final {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            std::coroutine_handle<> c = h.promise().continuation;
+            return c ? c : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    Final final_suspend() noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    T value{};
+    void return_value(T v) { value = std::move(v); }
+    T result() {
+        if (error) std::rethrow_exception(error);
+        return std::move(value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    void return_void() {}
+    void result() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+} // namespace itla_detail
+
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : itla_detail::Promise<T> {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Task(Task &&o) noexcept : h(std::exchange(o.h, {})) {}
+    Task &operator=(Task &&o) noexcept {
+        if (this != &o) {
+            if (h) h.destroy();
+            h = std::exchange(o.h, {});
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    ~Task() { if (h) h.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept {
+        h.promise().continuation = c;
+        return h;
+    }
+    T await_resume() { return h.promise().result(); }
+
+    Handle handle() const { return h; }
+
+private:
+    explicit Task(Handle handle) : h(handle) {}
+    Handle h;
+};
+
+// ---------- Executor ----------
+
+class IoWatcher {
+public:
+    virtual ~IoWatcher() {}
+    virtual void onReadable() = 0;
+};
+
+class EpollExecutor {
+public:
+    typedef std::multimap<uint64_t, std::function<void()>>::iterator TimerId;
+
+    EpollExecutor();
+    ~EpollExecutor();
+
+    // Start a top-level procedure; run() returns once all of them finished
+    void spawn(Task<void> t);
+    // Rethrows the first exception that escaped a spawned task
+    void run();
+
+    // Resume h on the next turn of the loop
+    void post(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    uint64_t nowUs() const;
+    TimerId addTimer(uint64_t deadlineUs, std::function<void()> fn);
+    void cancelTimer(TimerId id) { timers.erase(id); }
+
+    bool watch(int fd, IoWatcher *w);
+    void unwatch(int fd);
+
+    struct SleepAwaiter {
+        EpollExecutor &ex;
+        uint32_t ms;
+        bool await_ready() const noexcept { return ms == 0; }
+        void await_suspend(std::coroutine_handle<> h) {
+            EpollExecutor *e = &ex;
+            ex.addTimer(ex.nowUs() + ms * 1000ULL, [e, h] { e->post(h); });
+        }
+        void await_resume() noexcept {}
+    };
+    SleepAwaiter sleep(uint32_t ms) { return SleepAwaiter{ *this, ms }; }
+
+private:
+    int epfd;
+    std::deque<std::coroutine_handle<>> ready;
+    std::multimap<uint64_t, std::function<void()>> timers;
+    std::vector<Task<void>> roots;
+};
+
+// ---------- Port ----------
+
+class AsyncITLA : private IoWatcher {
+public:
+    static const uint32_t RESPONSE_TIMEOUT_MS = 100;    // beyond two frame times
+    static const uint32_t PENDING_TIMEOUT_MS = 30000;
+    static const uint32_t PENDING_POLL_MS = 10;
+
+    AsyncITLA(EpollExecutor &ex, const char *path);
+    ~AsyncITLA();
+
+    // Auto-baud: NOP at each MSA rate until the module answers
+    Task<bool> begin();
+
+    // status/error as in LinkReply; an XE is followed by a NOP read for the code
+    Task<LinkReply> read(Reg reg) { return readRaw((uint8_t)reg); }
+    Task<LinkReply> write(Reg reg, uint16_t value) { return writeRaw((uint8_t)reg, value); }
+    Task<LinkReply> readRaw(uint8_t reg);
+    Task<LinkReply> writeRaw(uint8_t reg, uint16_t value);
+
+    // Poll NOP until no operation is pending
+    Task<bool> waitPending(uint32_t timeoutMs = PENDING_TIMEOUT_MS);
+    // CHANNELH, CHANNEL (commits the tune), then wait for the pending flag
+    Task<bool> tune(uint32_t channel);
+
+    const std::string &name() const { return path; }
+    long baud() const { return baudRate; }
+    uint64_t transactions() const { return txCount; }
+
+private:
+    // One frame exchange; queued behind whatever is in flight on this port
+    struct TxAwaiter {
+        AsyncITLA &port;
+        uint8_t frame[ITLA_FRAME_LEN];
+        LinkReply result;
+        std::coroutine_handle<> h;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { h = handle; port.enqueue(this); }
+        LinkReply await_resume() const noexcept { return result; }
+    };
+    TxAwaiter transact(uint8_t reg, bool write, uint16_t data);
+
+    EpollExecutor &ex;
+    std::string path;
+    HardwareSerial serial;
+    long baudRate;
+    std::deque<TxAwaiter *> waiting;
+    TxAwaiter *current;
+    ITLAFrameAssembler rx;
+    EpollExecutor::TimerId timeout;
+    bool timerLive;
+    uint64_t txCount;
+
+    void setBaud(long baud);
+    void enqueue(TxAwaiter *tx);
+    void startNext();
+    void complete(uint8_t status, uint16_t data);
+    void onReadable() override;
+};
+
+#endif // ITLA_ASYNC_H
@@ -0,0 +1,205 @@
+// File: host/ITLA_FrameScan.cpp
+#include "ITLA_FrameScan.h"
+
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRAME_SCAN_X86 1
+#endif
+
+// Offset of the frame bytes in a record; the SIMD paths load them as one
+// little-endian word, byte 0 in bits 7:0
+static const size_t DATA_OFFSET = offsetof(TraceRecord, data);
+
+// ---- scalar: the reference ----
+
+static void decodeScalar(const TraceRecord *records, size_t n, DecodedFrame *out) {
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *d = records[i].data;
+        DecodedFrame &f = out[i];
+        f.flags = (uint8_t)((d[0] & 0x0B) | (itlaFrameValid(d) ? DECODED_BIP_OK : 0));
+        f.reg = d[1];
+        f.data = (uint16_t)((d[2] << 8) | d[3]);
+    }
+}
+
+// ---- SIMD ----
+// Per 32-bit lane w = b0 | b1 << 8 | b2 << 16 | b3 << 24:
+//   x    = (b0 & 0x0F) ^ b1 ^ b2 ^ b3       fold w & 0xFFFFFF0F by 16 then 8
+//   bip  = (x ^ x >> 4) & 0x0F              must equal b0 >> 4
+//   out  = (b0 & 0x0B) | ok << 4 | b1 << 8 | b3 << 16 | b2 << 24
+
+#ifdef FRAME_SCAN_X86
+
+__attribute__((target("sse2")))
+static inline __m128i decodeLanes128(__m128i w) {
+    const __m128i lowNibble = _mm_set1_epi32(0x0F);
+    __m128i x = _mm_and_si128(w, _mm_set1_epi32((int)0xFFFFFF0F));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 8));
+    __m128i bip = _mm_and_si128(_mm_xor_si128(x, _mm_srli_epi32(x, 4)), lowNibble);
+    __m128i sent = _mm_and_si128(_mm_srli_epi32(w, 4), lowNibble);
+    __m128i ok = _mm_and_si128(_mm_cmpeq_epi32(bip, sent), _mm_set1_epi32(DECODED_BIP_OK));
+
+    __m128i out = _mm_or_si128(_mm_and_si128(w, _mm_set1_epi32(0x0000FF0B)), ok);
+    out = _mm_or_si128(out, _mm_and_si128(_mm_srli_epi32(w, 8), _mm_set1_epi32(0x00FF0000)));
+    out = _mm_or_si128(out, _mm_and_si128(_mm_slli_epi32(w, 8), _mm_set1_epi32((int)0xFF000000)));
+    return out;
+}
+
+__attribute__((target("sse2")))
+static void decodeSse2(const TraceRecord *records, size_t n, DecodedFrame *out) {
+    // Four records are three vectors; their data words are dwords 2, 5, 8 and 11
+    static_assert(sizeof(TraceRecord) == 12 && offsetof(TraceRecord, data) == 8, "record layout");
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i *p = (const __m128i *)(records + i);
+        __m128i v0 = _mm_loadu_si128(p), v1 = _mm_loadu_si128(p + 1), v2 = _mm_loadu_si128(p + 2);
+        __m128i lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(v0, 2), _mm_shuffle_epi32(v1, 1));
+        __m128i hi = _mm_shuffle_epi32(v2, _MM_SHUFFLE(3, 0, 3, 0));
+        _mm_storeu_si128((__m128i *)(out + i), decodeLanes128(_mm_unpacklo_epi64(lo, hi)));
+    }
+    decodeScalar(records + i, n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i decodeLanes256(__m256i w) {
+    const __m256i lowNibble = _mm256_set1_epi32(0x0F);
+    __m256i x = _mm256_and_si256(w, _mm256_set1_epi32((int)0xFFFFFF0F));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 8));
+    __m256i bip = _mm256_and_si256(_mm256_xor_si256(x, _mm256_srli_epi32(x, 4)), lowNibble);
+    __m256i sent = _mm256_and_si256(_mm256_srli_epi32(w, 4), lowNibble);
+    __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi32(bip, sent), _mm256_set1_epi32(DECODED_BIP_OK));
+
+    __m256i out = _mm256_or_si256(_mm256_and_si256(w, _mm256_set1_epi32(0x0000FF0B)), ok);
+    out = _mm256_or_si256(out, _mm256_and_si256(_mm256_srli_epi32(w, 8), _mm256_set1_epi32(0x00FF0000)));
+    out = _mm256_or_si256(out, _mm256_and_si256(_mm256_slli_epi32(w, 8), _mm256_set1_epi32((int)0xFF000000)));
+    return out;
+}
+
+__attribute__((target("avx2")))
+static void decodeAvx2(const TraceRecord *records, size_t n, DecodedFrame *out) {
+    // Byte offsets of the data words of eight consecutive records
+    const __m256i stride = _mm256_setr_epi32(0, 12, 24, 36, 48, 60, 72, 84);
+    const int *base = (const int *)((const uint8_t *)records + DATA_OFFSET);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i w = _mm256_i32gather_epi32((const int *)((const uint8_t *)base + i * sizeof(TraceRecord)), stride, 1);
+        _mm256_storeu_si256((__m256i *)(out + i), decodeLanes256(w));
+    }
+    decodeSse2(records + i, n - i, out + i);
+}
+
+#endif // FRAME_SCAN_X86
+
+bool frameDecoderAvailable(FrameDecoder d) {
+    switch (d) {
+    case DECODE_SCALAR: return true;
+#ifdef FRAME_SCAN_X86
+    case DECODE_SSE2: return __builtin_cpu_supports("sse2");
+    case DECODE_AVX2: return __builtin_cpu_supports("avx2");
+#else
+    default: return false;
+#endif
+    }
+    return false;
+}
+
+FrameDecoder frameDecoderBest() {
+    if (frameDecoderAvailable(DECODE_AVX2)) return DECODE_AVX2;
+    if (frameDecoderAvailable(DECODE_SSE2)) return DECODE_SSE2;
+    return DECODE_SCALAR;
+}
+
+const char *frameDecoderName(FrameDecoder d) {
+    switch (d) {
+    case DECODE_SCALAR: return "scalar";
+    case DECODE_SSE2: return "sse2";
+    case DECODE_AVX2: return "avx2";
+    }
+    return "?";
+}
+
+void frameDecode(const TraceRecord *records, size_t n, DecodedFrame *out, FrameDecoder d) {
+    if (!frameDecoderAvailable(d)) d = DECODE_SCALAR;
+#ifdef FRAME_SCAN_X86
+    if (d == DECODE_AVX2) return decodeAvx2(records, n, out);
+    if (d == DECODE_SSE2) return decodeSse2(records, n, out);
+#endif
+    decodeScalar(records, n, out);
+}
+
+// ---- triage ----
+
+void FrameTriage::merge(const FrameTriage &o) {
+    records += o.records;
+    tx += o.tx;
+    rx += o.rx;
+    txBipBad += o.txBipBad;
+    rxBipBad += o.rxBipBad;
+    partial += o.partial;
+    ce += o.ce;
+    for (int i = 0; i < 4; i++) status[i] += o.status[i];
+    for (int i = 0; i < 256; i++) {
+        rxByReg[i] += o.rxByReg[i];
+        xeByReg[i] += o.xeByReg[i];
+    }
+}
+
+void frameTriage(const TraceRecord *records, size_t n, FrameTriage &t, FrameDecoder d) {
+    // Decode a block at a time so the decoded frames stay in L1
+    static const size_t BLOCK = 1024;
+    DecodedFrame decoded[BLOCK];
+    t.records += n;
+    for (size_t start = 0; start < n; start += BLOCK) {
+        size_t m = n - start < BLOCK ? n - start : BLOCK;
+        frameDecode(records + start, m, decoded, d);
+        for (size_t i = 0; i < m; i++) {
+            const TraceRecord &r = records[start + i];
+            if (r.kind != TRACE_TX && r.kind != TRACE_RX) continue;
+            if (r.len != ITLA_FRAME_LEN) {
+                t.partial++;
+                continue;
+            }
+            const DecodedFrame &f = decoded[i];
+            if (r.kind == TRACE_TX) {
+                t.tx++;
+                if (!decodedValid(f)) t.txBipBad++;
+                continue;
+            }
+            t.rx++;
+            if (!decodedValid(f)) {
+                t.rxBipBad++;
+                continue;
+            }
+            if (decodedCE(f)) t.ce++;
+            t.status[decodedStatus(f)]++;
+            t.rxByReg[f.reg]++;
+            if (decodedStatus(f) == ITLA_ST_XE) t.xeByReg[f.reg]++;
+        }
+    }
+}
+
+void frameTriageParallel(const TraceFile &trace, unsigned threads, FrameTriage &t, FrameDecoder d) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    size_t n = trace.size();
+    if (n < (size_t)threads * 65536) threads = 1;   // not worth a thread
+    if (n == 0) return;
+
+    const TraceRecord *records = &trace[0];
+    std::vector<FrameTriage> parts(threads, FrameTriage());
+    std::vector<std::thread> pool;
+    size_t per = (n + threads - 1) / threads;
+    for (unsigned k = 0; k < threads; k++) {
+        size_t from = k * per, to = from + per < n ? from + per : n;
+        if (from >= to) break;
+        pool.emplace_back([=, &parts]() { frameTriage(records + from, to - from, parts[k], d); });
+    }
+    for (std::thread &th : pool) th.join();
+    for (const FrameTriage &p : parts) t.merge(p);
+}
@@ -0,0 +1,69 @@
+// File: host/ITLA_FrameScan.h
+// Bulk BIP-4 check and field extraction for wire traces (ITLA_Trace.h), for
+// offline triage of long captures. The same decode is done three ways:
+//   scalar  itlaFrameValid() and the field layout of ITLA_Frame.h, one frame
+//           at a time: the reference
+//   sse2    four frames per instruction
+//   avx2    eight frames per instruction (gathered from the 12-byte records)
+// picked at run time by what the CPU has, so the host build line needs no
+// -m flags. All three give bit-identical DecodedFrames (itla_trace scan
+// --check compares them over a whole trace).
+//
+// frameTriage() counts a range of records; frameTriageParallel() splits a
+// mapped trace into one range per thread and merges the counts. RX records
+// that do not hold exactly one frame (a dropped or stray byte moved the
+// grouping) are counted as partial and not decoded.
+#ifndef ITLA_FRAME_SCAN_H
+#define ITLA_FRAME_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ITLA_Frame.h"
+#include "ITLA_TraceFile.h"
+
+// One frame, fields in place. flags holds byte 0 bits 3, 1 and 0 as sent
+// (CE / LstRsp, status or R/W) plus DECODED_BIP_OK.
+struct DecodedFrame {
+    uint8_t flags;
+    uint8_t reg;
+    uint16_t data;
+};
+
+#define DECODED_BIP_OK 0x10
+
+static_assert(sizeof(DecodedFrame) == 4, "DecodedFrame is filled as one 32-bit lane");
+
+inline uint8_t decodedStatus(const DecodedFrame &f) { return f.flags & 0x03; }
+inline bool decodedCE(const DecodedFrame &f) { return (f.flags & 0x08) != 0; }
+inline bool decodedWrite(const DecodedFrame &f) { return (f.flags & 0x01) != 0; }
+inline bool decodedValid(const DecodedFrame &f) { return (f.flags & DECODED_BIP_OK) != 0; }
+
+enum FrameDecoder { DECODE_SCALAR, DECODE_SSE2, DECODE_AVX2 };
+
+FrameDecoder frameDecoderBest();
+bool frameDecoderAvailable(FrameDecoder d);
+const char *frameDecoderName(FrameDecoder d);
+
+// out[i] from the data bytes of records[i], whatever its kind and length
+void frameDecode(const TraceRecord *records, size_t n, DecodedFrame *out, FrameDecoder d);
+
+struct FrameTriage {
+    uint64_t records;
+    uint64_t tx, rx;            // whole frames by direction
+    uint64_t txBipBad, rxBipBad;
+    uint64_t partial;           // TX/RX records of 1..3 bytes
+    uint64_t ce;                // RX with CE set (BIP good)
+    uint64_t status[4];         // RX by status (BIP good)
+    uint64_t rxByReg[256];      // RX per register (BIP good)
+    uint64_t xeByReg[256];      // of those, XE
+
+    void merge(const FrameTriage &o);
+};
+
+// Counts records[0..n) into t (added to what is there)
+void frameTriage(const TraceRecord *records, size_t n, FrameTriage &t, FrameDecoder d);
+// The whole trace on `threads` threads (0: one per core)
+void frameTriageParallel(const TraceFile &trace, unsigned threads, FrameTriage &t, FrameDecoder d);
+
+#endif // ITLA_FRAME_SCAN_H
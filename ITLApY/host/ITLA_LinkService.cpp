@@ -0,0 +1,408 @@
+// File: host/ITLA_LinkService.cpp
+#include "ITLA_LinkService.h"
+
+// ---------- Ring ----------
+
+LinkService::Ring::Ring() : tail(0), head(0) {
+    for (size_t i = 0; i < QUEUE_CAPACITY; i++) {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+        cells[i].item = nullptr;
+    }
+}
+
+bool LinkService::Ring::push(Request *r) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &c = cells[pos & (QUEUE_CAPACITY - 1)];
+        size_t seq = c.seq.load(std::memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                c.item = r;
+                c.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false;   // full
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+LinkService::Request *LinkService::Ring::pop() {
+    Cell &c = cells[head & (QUEUE_CAPACITY - 1)];
+    if (c.seq.load(std::memory_order_acquire) != head + 1) return nullptr;
+    Request *r = c.item;
+    c.seq.store(head + QUEUE_CAPACITY, std::memory_order_release);
+    head++;
+    return r;
+}
+
+// ---------- Lifecycle ----------
+
+LinkService::LinkService(ITLA &itla)
+    : itla(itla), aea(nullptr), wake(0), idle(false), urgent(0), freed(0), blockedProducers(0),
+      running(false), txCount(0), coalesced(0), backgroundOwed(false) {
+    for (int p = 0; p < PRIO_CLASSES; p++) {
+        waits[p].count = 0;
+        waits[p].totalNs = 0;
+        waits[p].maxNs = 0;
+    }
+}
+
+LinkService::~LinkService() {
+    stop();
+}
+
+void LinkService::start() {
+    if (running.exchange(true)) return;
+    itla.setYieldHook(&LinkService::yieldThunk, this);
+    owner = std::thread(&LinkService::run, this);
+}
+
+void LinkService::stop() {
+    if (!running.exchange(false)) return;
+    wake.fetch_add(1);
+    wake.notify_one();
+    owner.join();
+    itla.setYieldHook(0, 0);
+    // Anything that raced in after the owner's last pass
+    for (int p = 0; p < PRIO_CLASSES; p++) {
+        while (Request *r = rings[p].pop()) fail(r);
+    }
+}
+
+// ---------- Submission ----------
+
+std::future<LinkReply> LinkService::read(uint8_t reg, LinkPriority prio) {
+    Request *r = new Request(Request::READ, prio);
+    r->op = LinkOp{ reg, false, 0 };
+    std::future<LinkReply> f = r->reply.get_future();
+    submit(r);
+    return f;
+}
+
+std::future<LinkReply> LinkService::write(uint8_t reg, uint16_t value) {
+    return write(reg, value, reg == ITLA_REG_RESETA ? PRIO_SAFETY : PRIO_CONTROL);
+}
+
+std::future<LinkReply> LinkService::write(uint8_t reg, uint16_t value, LinkPriority prio) {
+    Request *r = new Request(Request::WRITE, prio);
+    r->op = LinkOp{ reg, true, value };
+    std::future<LinkReply> f = r->reply.get_future();
+    submit(r);
+    return f;
+}
+
+std::future<std::vector<LinkReply>> LinkService::batch(std::vector<LinkOp> ops, LinkPriority prio) {
+    Request *r = new Request(Request::BATCH, prio);
+    r->ops = std::move(ops);
+    std::future<std::vector<LinkReply>> f = r->replies.get_future();
+    submit(r);
+    return f;
+}
+
+std::future<std::string> LinkService::readString(uint8_t reg, LinkPriority prio) {
+    if (prio == PRIO_SAFETY) prio = PRIO_CONTROL;   // SAFETY is for single frames
+    Request *r = new Request(Request::STRING, prio);
+    r->op = LinkOp{ reg, false, 0 };
+    std::future<std::string> f = r->textReply.get_future();
+    submit(r);
+    return f;
+}
+
+void LinkService::submit(Request *r) {
+    if (!running.load()) {
+        fail(r);
+        return;
+    }
+    Ring &ring = rings[r->prio];
+    // Ring full: sleep until the owner frees cells (backpressure, no spinning)
+    while (!ring.push(r)) {
+        uint32_t seen = freed.load();
+        blockedProducers.fetch_add(1);
+        if (!ring.push(r)) {
+            freed.wait(seen);
+            blockedProducers.fetch_sub(1);
+            continue;
+        }
+        blockedProducers.fetch_sub(1);
+        break;
+    }
+    if (r->prio == PRIO_SAFETY) urgent.release();
+    wake.fetch_add(1);
+    if (idle.load()) wake.notify_one();
+}
+
+LinkWaitStats LinkService::waitStats(LinkPriority prio) const {
+    LinkWaitStats s;
+    s.count = waits[prio].count.load(std::memory_order_relaxed);
+    s.totalNs = waits[prio].totalNs.load(std::memory_order_relaxed);
+    s.maxNs = waits[prio].maxNs.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ---------- Owner thread ----------
+
+LinkService::Request *LinkService::take(LinkPriority prio) {
+    return rings[prio].pop();
+}
+
+void LinkService::run() {
+    for (;;) {
+        if (serviceOnce()) {
+            freed.fetch_add(1);
+            if (blockedProducers.load()) freed.notify_all();
+            continue;
+        }
+        if (!running.load()) return;
+
+        // Sleep until a producer bumps `wake`. Re-check after announcing
+        // idle so a push that missed the flag is not lost.
+        uint32_t seen = wake.load();
+        idle.store(true);
+        bool worked = serviceOnce();
+        if (!worked && running.load()) wake.wait(seen);
+        idle.store(false);
+    }
+}
+
+// Serve the highest class that has work: all pending SAFETY, then the next
+// chunk of an AEA string in progress or the first of a held string, otherwise
+// one CONTROL request, one telemetry window, or one background step.
+bool LinkService::serviceOnce() {
+    bool worked = runSafety();
+    if (aea) {
+        stepString(aea);
+        return true;
+    }
+    if (!heldStrings.empty()) {
+        Request *r = heldStrings.front();
+        heldStrings.pop_front();
+        stepString(r);
+        return true;
+    }
+    if (worked) return true;
+    // A telemetry window that ran last pass owes background one step, so a
+    // constant telemetry load slows AEA reads down but never starves them
+    if (backgroundOwed) {
+        backgroundOwed = false;
+        if (serviceClass(PRIO_BACKGROUND)) return true;
+    }
+    for (int p = PRIO_CONTROL; p < PRIO_CLASSES; p++) {
+        if (serviceClass((LinkPriority)p)) return true;
+    }
+    return false;
+}
+
+// One scheduling step for a single class; false when it had nothing to do
+bool LinkService::serviceClass(LinkPriority prio) {
+    if (prio == PRIO_TELEMETRY) {
+        std::vector<Request *> window;
+        while (window.size() < DRAIN_MAX) {
+            Request *r = take(prio);
+            if (!r) break;
+            window.push_back(r);
+            if (r->kind == Request::STRING) break;   // it takes the link: last in the window
+        }
+        if (window.empty()) return false;
+        executeReads(window);
+        backgroundOwed = true;
+        return true;
+    }
+    if (Request *r = take(prio)) {
+        execute(r);
+        return true;
+    }
+    return false;
+}
+
+// Run everything queued in classes above prio (between frames of a lower
+// class). A CONTROL string is held, not started, since the rest of the lower
+// class's window would interleave with it; CONTROL stops there to keep order.
+void LinkService::serviceAbove(LinkPriority prio) {
+    runSafety();
+    if (prio <= PRIO_CONTROL || aea) return;
+    while (Request *r = take(PRIO_CONTROL)) {
+        if (r->kind == Request::STRING) {
+            heldStrings.push_back(r);
+            return;
+        }
+        execute(r);
+    }
+}
+
+// While an AEA string is in progress only single-register writes run; the
+// rest are held until it finishes, then run ahead of newer SAFETY requests
+bool LinkService::runSafety() {
+    bool worked = false;
+    while (urgent.try_acquire()) {}
+    while (!aea && !heldSafety.empty()) {
+        Request *r = heldSafety.front();
+        heldSafety.pop_front();
+        execute(r);
+        worked = true;
+    }
+    while (Request *r = take(PRIO_SAFETY)) {
+        if (aea && r->kind != Request::WRITE) {
+            heldSafety.push_back(r);
+            continue;
+        }
+        execute(r);
+        worked = true;
+    }
+    return worked;
+}
+
+void LinkService::yieldThunk(void *ctx, unsigned long ms) {
+    static_cast<LinkService *>(ctx)->onYield(ms);
+}
+
+// Driver hook: before every frame, and in place of its pending-op sleeps
+void LinkService::onYield(unsigned long ms) {
+    runSafety();
+    if (ms == 0) return;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(ms);
+    while (Clock::now() < deadline) {
+        if (urgent.try_acquire_until(deadline)) runSafety();
+    }
+}
+
+void LinkService::noteWait(const Request *r) {
+    uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - r->queued).count();
+    WaitCounters &w = waits[r->prio];
+    w.count.store(w.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    w.totalNs.store(w.totalNs.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    if (ns > w.maxNs.load(std::memory_order_relaxed)) w.maxNs.store(ns, std::memory_order_relaxed);
+}
+
+LinkReply LinkService::transact(const LinkOp &op) {
+    LinkReply rep;
+    if (op.write) {
+        itla.writeRegister(op.reg, op.value);
+        rep.value = op.value;
+    } else {
+        rep.value = itla.readRegister(op.reg);
+    }
+    rep.status = itla.lastStatus();
+    rep.error = itla.lastErrorCode();
+    txCount.fetch_add(1, std::memory_order_relaxed);
+    return rep;
+}
+
+void LinkService::execute(Request *r) {
+    switch (r->kind) {
+        case Request::READ:
+        case Request::WRITE:
+            noteWait(r);
+            r->reply.set_value(transact(r->op));
+            break;
+        case Request::BATCH: {
+            noteWait(r);
+            std::vector<LinkReply> out;
+            out.reserve(r->ops.size());
+            for (const LinkOp &op : r->ops) out.push_back(transact(op));
+            r->replies.set_value(std::move(out));
+            break;
+        }
+        case Request::STRING:
+            // One string at a time: a second length read would move the AEA pointer
+            if (aea || !heldStrings.empty()) heldStrings.push_back(r);
+            else stepString(r);
+            return;   // stepString owns r
+        case Request::CALL:
+            noteWait(r);
+            r->fn(itla);
+            break;
+    }
+    delete r;
+}
+
+void LinkService::executeReads(std::vector<Request *> &window) {
+    size_t i = 0;
+    while (i < window.size()) {
+        if (window[i]->kind != Request::READ) {
+            serviceAbove(PRIO_TELEMETRY);
+            execute(window[i]);
+            i++;
+            continue;
+        }
+
+        // A run of plain reads with no write in between: each register is
+        // read once and the value handed to every caller that asked for it
+        size_t end = i;
+        while (end < window.size() && window[end]->kind == Request::READ) end++;
+        for (size_t a = i; a < end; a++) {
+            if (!window[a]) continue;
+            serviceAbove(PRIO_TELEMETRY);
+            uint8_t reg = window[a]->op.reg;
+            LinkReply rep = transact(window[a]->op);
+            for (size_t b = a; b < end; b++) {
+                if (!window[b] || window[b]->op.reg != reg) continue;
+                if (b != a) coalesced.fetch_add(1, std::memory_order_relaxed);
+                noteWait(window[b]);
+                window[b]->reply.set_value(rep);
+                delete window[b];
+                window[b] = nullptr;
+            }
+        }
+        i = end;
+    }
+}
+
+// One transaction of an AEA string read; stays the string in progress
+// (aea) until done
+void LinkService::stepString(Request *r) {
+    bool done = false;
+    if (r->remaining < 0) {
+        noteWait(r);
+        uint16_t len = itla.readRegister(r->op.reg);
+        txCount.fetch_add(1, std::memory_order_relaxed);
+        if (itla.lastStatus() != ITLA_ST_AEA) done = true;
+        else r->remaining = len & 0xFF;
+        if (r->remaining == 0) done = true;
+    } else {
+        uint16_t chunk = itla.readRegister(ITLA_REG_EAR);
+        txCount.fetch_add(1, std::memory_order_relaxed);
+        char c1 = (char)(chunk >> 8);
+        char c2 = (char)chunk;
+        if (itla.lastStatus() != 0 || c1 == '\0') {
+            done = true;
+        } else {
+            r->text += c1;
+            if (--r->remaining <= 0 || c2 == '\0') {
+                done = true;
+            } else {
+                r->text += c2;
+                done = --r->remaining <= 0;
+            }
+        }
+    }
+    if (!done) {
+        aea = r;
+        return;
+    }
+    aea = nullptr;
+    r->textReply.set_value(r->text);
+    delete r;
+}
+
+void LinkService::fail(Request *r) {
+    LinkReply rep = { 0, 0xFF, ITLA_ERR_OK };
+    switch (r->kind) {
+        case Request::READ:
+        case Request::WRITE:
+            r->reply.set_value(rep);
+            break;
+        case Request::BATCH:
+            r->replies.set_value(std::vector<LinkReply>(r->ops.size(), rep));
+            break;
+        case Request::STRING:
+            r->textReply.set_value(std::string());
+            break;
+        case Request::CALL:
+            break;   // dropping the task breaks its promise (std::future_error)
+    }
+    delete r;
+}
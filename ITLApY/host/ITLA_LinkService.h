@@ -0,0 +1,186 @@
+// File: host/ITLA_LinkService.h
+// One thread owns each serial link; everyone else talks to the module through
+// it. Callers (GUI bridge, monitoring, automation) submit requests from any
+// thread into bounded lock-free MPSC rings and get std::futures back, so
+// frames from different callers never interleave on the wire.
+//  - A batch takes a single ring slot and runs back to back; only SAFETY
+//    requests may cut in between its frames.
+//  - Duplicate telemetry reads queued between two writes share one transaction.
+//  - Producers only contend on one CAS; the owner sleeps on an atomic
+//    wait when idle, so there is no mutex for callers to convoy on.
+//
+// Priority classes, one ring each. The owner always serves the highest
+// non-empty class, and checks for SAFETY work before every frame, including
+// the frames of a running call() and the driver's pending-op polling (via
+// ITLA::setYieldHook). A RESETA write therefore waits at most for the frame
+// already on the wire. An AEA string owns the link from its length read to
+// its last EAR chunk: the module has a single AEA pointer, and any other AEA
+// read in between (another string, a call() or read of an AEA register)
+// would move it. Only SAFETY writes cut in between chunks; other SAFETY
+// requests wait for the string, and a second string queues behind it (a
+// telemetry window ends at a string). Background still gets one step after
+// each telemetry window so it cannot starve.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -pthread -Ihost -I. host/Arduino.cpp host/ITLA_LinkService.cpp
+//       ITLA_.cpp ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp <your main>
+#ifndef ITLA_LINKSERVICE_H
+#define ITLA_LINKSERVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ITLA.h"
+#include "ITLA_Frame.h"
+
+// Result of one register transaction (status as ITLA::lastStatus())
+struct LinkReply {
+    uint16_t value;
+    uint8_t status;    // 0 OK, 1 XE, 2 AEA, 3 CP, 0xFE CE, 0xFF no response / service stopped
+    uint8_t error;     // ITLA_ERR_* when status is XE
+};
+
+struct LinkOp {
+    uint8_t reg;
+    bool write;
+    uint16_t value;
+};
+
+enum LinkPriority {
+    PRIO_SAFETY,       // laser shutdown (RESETA writes by default)
+    PRIO_CONTROL,      // setpoint writes, tunes
+    PRIO_TELEMETRY,    // periodic reads
+    PRIO_BACKGROUND,   // AEA strings, discovery
+    PRIO_CLASSES
+};
+
+// Time requests of one class spent queued before reaching the link
+struct LinkWaitStats {
+    uint64_t count;
+    uint64_t totalNs;
+    uint64_t maxNs;
+};
+
+class LinkService {
+public:
+    static const size_t QUEUE_CAPACITY = 256;   // per class, power of two
+    static const size_t DRAIN_MAX = 64;         // telemetry reads taken per pass
+
+    // itla must already be begin()'d; it is only touched by the owner thread from now on
+    explicit LinkService(ITLA &itla);
+    ~LinkService();
+
+    void start();
+    // Finish what is queued, then join the owner thread
+    void stop();
+
+    std::future<LinkReply> read(uint8_t reg, LinkPriority prio = PRIO_TELEMETRY);
+    // RESETA writes are SAFETY, everything else CONTROL
+    std::future<LinkReply> write(uint8_t reg, uint16_t value);
+    std::future<LinkReply> write(uint8_t reg, uint16_t value, LinkPriority prio);
+
+    // Ops run in order with no other request between them (except SAFETY)
+    std::future<std::vector<LinkReply>> batch(std::vector<LinkOp> ops, LinkPriority prio = PRIO_CONTROL);
+
+    // AEA string (SN, manufacturer, ...); holds the link until read, SAFETY
+    // writes aside. Empty on error.
+    std::future<std::string> readString(uint8_t reg, LinkPriority prio = PRIO_BACKGROUND);
+
+    // Run fn(itla) on the owner thread (compound driver calls: tune, profile, ...)
+    template <typename Fn>
+    auto call(Fn fn, LinkPriority prio = PRIO_CONTROL) -> std::future<decltype(fn(std::declval<ITLA &>()))> {
+        typedef decltype(fn(std::declval<ITLA &>())) R;
+        auto task = std::make_shared<std::packaged_task<R(ITLA &)>>(std::move(fn));
+        std::future<R> f = task->get_future();
+        Request *r = new Request(Request::CALL, prio);
+        r->fn = [task](ITLA &itla) { (*task)(itla); };
+        submit(r);
+        return f;
+    }
+
+    uint64_t transactions() const { return txCount.load(std::memory_order_relaxed); }
+    uint64_t coalescedReads() const { return coalesced.load(std::memory_order_relaxed); }
+    LinkWaitStats waitStats(LinkPriority prio) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request {
+        enum Kind { READ, WRITE, BATCH, STRING, CALL } kind;
+        LinkPriority prio;
+        Clock::time_point queued;
+        LinkOp op;
+        std::promise<LinkReply> reply;
+        std::vector<LinkOp> ops;
+        std::promise<std::vector<LinkReply>> replies;
+        std::function<void(ITLA &)> fn;
+        // STRING progress
+        std::string text;
+        int16_t remaining;          // bytes still to read, -1 before the length is known
+        std::promise<std::string> textReply;
+
+        Request(Kind k, LinkPriority p) : kind(k), prio(p), queued(Clock::now()), op(), remaining(-1) {}
+    };
+
+    // Vyukov bounded queue: each cell's sequence number says whose turn it is
+    struct Cell {
+        std::atomic<size_t> seq;
+        Request *item;
+    };
+    struct Ring {
+        Cell cells[QUEUE_CAPACITY];
+        alignas(64) std::atomic<size_t> tail;   // producers
+        alignas(64) size_t head;                // owner only
+
+        Ring();
+        bool push(Request *r);
+        Request *pop();
+    };
+
+    struct WaitCounters {
+        std::atomic<uint64_t> count, totalNs, maxNs;
+    };
+
+    ITLA &itla;
+    Ring rings[PRIO_CLASSES];
+    Request *aea;                            // AEA string in progress (owner only)
+    std::deque<Request *> heldSafety;        // SAFETY requests waiting for it (owner only)
+    std::deque<Request *> heldStrings;       // strings taken while it ran, in order (owner only)
+    alignas(64) std::atomic<uint32_t> wake;  // bumped per submit; owner waits on it
+    std::atomic<bool> idle;
+    std::counting_semaphore<> urgent;        // released per SAFETY submit, for timed waits
+    std::atomic<uint32_t> freed;             // bumped when the owner frees cells
+    std::atomic<uint32_t> blockedProducers;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> txCount, coalesced;
+    WaitCounters waits[PRIO_CLASSES];
+    bool backgroundOwed;                     // owner only
+    std::thread owner;
+
+    void submit(Request *r);
+    Request *take(LinkPriority prio);
+    void run();
+    bool serviceOnce();
+    bool serviceClass(LinkPriority prio);
+    void serviceAbove(LinkPriority prio);
+    bool runSafety();
+    void execute(Request *r);
+    void executeReads(std::vector<Request *> &window);
+    void stepString(Request *r);
+    LinkReply transact(const LinkOp &op);
+    void fail(Request *r);
+    void noteWait(const Request *r);
+
+    static void yieldThunk(void *ctx, unsigned long ms);
+    void onYield(unsigned long ms);
+};
+
+#endif // ITLA_LINKSERVICE_H
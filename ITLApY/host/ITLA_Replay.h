@@ -0,0 +1,174 @@
+// File: host/ITLA_Replay.h
+// Plays a recorded wire trace (ITLA_Trace.h, host/ITLA_TraceFile.h) back to
+// the driver in place of a module.
+//   ReplayTransport  Transport policy: every write() is matched against the
+//                    next recorded TX, and the RX bytes recorded after it are
+//                    handed out at the same offsets from the write as in the
+//                    capture. begin() takes the next recorded BAUD.
+//   ScaledClock      Clock policy running `speed` times faster than real time.
+//                    The driver's timeouts, poll intervals and reacquire waits
+//                    run on it too, so they keep their place in the recorded
+//                    timeline at any speed; how fast it can go before host
+//                    sleep jitter shows up as extra timeouts depends on the
+//                    baud (a 1 ms oversleep at -x 50 is 50 ms of driver time).
+// For replay without waiting, use VirtualClock for the driver and
+// SimTimestamp for the transport (host/ITLA_Sim.h).
+//
+// A replay follows the trace by position, not by content: when the driver
+// sends something else than was recorded the mismatch is counted and the
+// recorded reply is served anyway, so a trace from another driver version
+// shows where the two part ways rather than stopping there.
+#ifndef ITLA_REPLAY_H
+#define ITLA_REPLAY_H
+
+#include <chrono>
+#include <deque>
+#include <thread>
+
+#include "ITLA_TraceFile.h"
+
+class ScaledClock {
+public:
+    explicit ScaledClock(double speed = 1.0) : speed(speed), t0(std::chrono::steady_clock::now()) {}
+    unsigned long ms() const { return (unsigned long)(elapsedUs() / 1000); }
+    unsigned long us() const { return (unsigned long)elapsedUs(); }
+    void sleep(unsigned long ms) const {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms / speed));
+    }
+    uint64_t elapsedUs() const {
+        std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - t0;
+        return (uint64_t)(d.count() * speed);
+    }
+
+private:
+    double speed;
+    std::chrono::steady_clock::time_point t0;   // copies share it, so driver and transport agree
+};
+
+template <class Clock>
+class ReplayTransport {
+public:
+    ReplayTransport(const TraceFile &trace, const Clock &clock)
+        : trace(trace), clock(clock), pos(0), atUs(0), matched(0), mismatched(0), pastEnd(0), served(0) {
+        if (trace.size()) atUs = timeline.unwrap(trace[0]);
+    }
+
+    // Index and recorded time (us since the first record) of the next TX or
+    // BAUD record, which the driver is expected to produce next; false at the end
+    bool nextAnchor(const TraceRecord *&r, uint64_t &recUs) {
+        skipToAnchor();
+        if (pos >= trace.size()) return false;
+        r = &trace[pos];
+        recUs = atUs;
+        return true;
+    }
+
+    void begin(long baud) {
+        rx.clear();   // opening the port discards what was buffered
+        skipToAnchor();
+        if (pos >= trace.size()) {
+            pastEnd++;
+            return;
+        }
+        const TraceRecord &r = trace[pos];
+        if (r.kind != TRACE_BAUD) {   // the capture kept the port open here
+            mismatched++;
+            return;
+        }
+        uint32_t recorded;
+        memcpy(&recorded, r.data, sizeof(recorded));
+        if (recorded == (uint32_t)baud) matched++;
+        else mismatched++;
+        consumeAnchor();
+    }
+
+    size_t write(const uint8_t *buf, size_t len) {
+        skipToAnchor();
+        if (pos >= trace.size() || trace[pos].kind != TRACE_TX) {
+            if (pos >= trace.size()) pastEnd++;
+            else mismatched++;   // a BAUD stays for the next begin()
+            return len;
+        }
+        // Frames are recorded in up to four-byte pieces with the same time
+        bool same = true;
+        size_t done = 0;
+        while (done < len && pos < trace.size() && trace[pos].kind == TRACE_TX) {
+            const TraceRecord &r = trace[pos];
+            for (uint8_t i = 0; i < r.len; i++)
+                if (done + i >= len || buf[done + i] != r.data[i]) same = false;
+            done += r.len;
+            if (done < len) take();
+            else break;
+        }
+        if (same && done == len) matched++;
+        else mismatched++;
+        consumeAnchor();
+        return len;
+    }
+
+    int available() {
+        uint64_t now = clock.us();
+        int n = 0;
+        for (const Pending &p : rx) {
+            if (p.dueUs > now) break;
+            n++;
+        }
+        return n;
+    }
+
+    int read() {
+        if (rx.empty() || rx.front().dueUs > (uint64_t)clock.us()) return -1;
+        uint8_t b = rx.front().b;
+        rx.pop_front();
+        served++;
+        return b;
+    }
+
+    uint32_t framesMatched() const { return matched; }     // TX and BAUD records the driver reproduced
+    uint32_t mismatches() const { return mismatched; }
+    uint32_t afterEnd() const { return pastEnd; }          // driver activity past the end of the trace
+    uint32_t bytesServed() const { return served; }
+    size_t position() const { return pos; }
+
+private:
+    struct Pending {
+        uint64_t dueUs;   // on the driver's clock
+        uint8_t b;
+    };
+
+    const TraceFile &trace;
+    Clock clock;
+    TraceTimeline timeline;
+    size_t pos;          // next record not consumed
+    uint64_t atUs;       // recorded time of trace[pos]
+    std::deque<Pending> rx;
+    uint32_t matched, mismatched, pastEnd, served;
+
+    // Step past trace[pos], keeping atUs on the record now at pos
+    void take() {
+        pos++;
+        if (pos < trace.size()) atUs = timeline.unwrap(trace[pos]);
+    }
+
+    // Past START records and RX that no anchor claimed (before the first TX)
+    void skipToAnchor() {
+        while (pos < trace.size() && trace[pos].kind != TRACE_TX && trace[pos].kind != TRACE_BAUD) take();
+    }
+
+    // The driver just did what trace[pos] records: queue the RX that followed
+    // it, up to the next anchor, at the recorded offsets from now
+    void consumeAnchor() {
+        uint64_t anchorUs = atUs;
+        uint64_t now = clock.us();
+        take();
+        while (pos < trace.size() && trace[pos].kind != TRACE_TX && trace[pos].kind != TRACE_BAUD) {
+            const TraceRecord &r = trace[pos];
+            if (r.kind == TRACE_RX)
+                for (uint8_t i = 0; i < r.len && i < sizeof(r.data); i++)
+                    rx.push_back(Pending{now + (atUs - anchorUs), r.data[i]});
+            take();
+        }
+    }
+};
+
+#endif // ITLA_REPLAY_H
@@ -0,0 +1,277 @@
+// File: host/ITLA_Sim.cpp
+#include "ITLA_Sim.h"
+#include "ITLA_Impl.h"
+
+#include <array>
+
+template class BasicITLA<SimTransport, VirtualClock, SimLogger>;
+
+// ---------- SimWorld ----------
+
+void SimWorld::at(uint64_t atUs, std::function<void()> fn) {
+    queue.emplace(atUs, std::move(fn));   // multimap keeps equal keys in insertion order
+}
+
+void SimWorld::runUntil(uint64_t t) {
+    while (!queue.empty() && queue.begin()->first <= t) {
+        auto it = queue.begin();
+        if (it->first > now) now = it->first;
+        std::function<void()> fn = std::move(it->second);
+        queue.erase(it);   // before running: fn may schedule more
+        fn();
+        events++;
+    }
+    if (t > now) now = t;
+}
+
+void SimWorld::advance(uint64_t us) {
+    runUntil(now + us);
+}
+
+void SimWorld::poll() {
+    uint64_t t = now + POLL_QUANTUM_US;
+    if (!queue.empty() && queue.begin()->first < t) t = queue.begin()->first > now ? queue.begin()->first : now;
+    runUntil(t);
+}
+
+// ---------- SimModule ----------
+
+// End of the n-th byte sent from t0: start + 8 data + stop bits each,
+// rounded up once so 4 bytes take what the driver's frameUs says
+static uint64_t wireEndUs(uint64_t t0, uint32_t n, long baud) {
+    return t0 + (n * 10ULL * 1000000ULL + baud - 1) / baud;
+}
+
+static const char *const AEA_DEV_TYPE = "CW ITLA";
+static const char *const AEA_MANUF = "SIM";
+static const char *const AEA_MODEL = "SIM-ITLA-1";
+static const char *const AEA_MFG_DATE = "2026-01-01";
+static const char *const AEA_RELEASE = "1.0.0";
+
+SimModule::SimModule(SimWorld &world, uint64_t seed, const SimModuleConfig &cfg)
+    : world(world), cfg(cfg), rng(seed), present(true), regs(), implemented(), aea(0), aeaPos(0), aeaLen(0),
+    lastErr(ITLA_ERR_OK), ceNext(false), channelCount(0), channel(1), fromChannel(1), pendingUntil(0),
+    tuneUs(0), answered(0)
+{
+    static const uint8_t implementedRegs[] = {
+        ITLA_REG_NOP, ITLA_REG_DEV_TYPE, ITLA_REG_MANUF, ITLA_REG_MODEL, ITLA_REG_SN, ITLA_REG_MFG_DATE,
+        ITLA_REG_RELEASE, ITLA_REG_REL_BACK, ITLA_REG_GEN_CFG, ITLA_REG_EAR, ITLA_REG_IOCAP,
+        ITLA_REG_STATUSF, ITLA_REG_STATUSW, ITLA_REG_FPOWTH, ITLA_REG_WPOWTH, ITLA_REG_FFREQTH,
+        ITLA_REG_WFREQTH, ITLA_REG_FTHERMTH, ITLA_REG_WTHERMTH, ITLA_REG_SRQT, ITLA_REG_FATALT, ITLA_REG_ALMT,
+        ITLA_REG_CHANNEL, ITLA_REG_POWER, ITLA_REG_RESETA, ITLA_REG_MCB, ITLA_REG_GRID, ITLA_REG_FCF1,
+        ITLA_REG_FCF2, ITLA_REG_LF1, ITLA_REG_LF2, ITLA_REG_OOP, ITLA_REG_TEMP, ITLA_REG_FTFR, ITLA_REG_OPSL,
+        ITLA_REG_OPSH, ITLA_REG_LFL1, ITLA_REG_LFL2, ITLA_REG_LFH1, ITLA_REG_LFH2, ITLA_REG_LGRID,
+        ITLA_REG_CURR, ITLA_REG_TEMPS, ITLA_REG_TBTFL, ITLA_REG_TBTFH, ITLA_REG_FAGETH, ITLA_REG_WAGETH,
+        ITLA_REG_AGE, ITLA_REG_FTF, ITLA_REG_CHANNELH, ITLA_REG_GRID2, ITLA_REG_FCF3, ITLA_REG_LF3,
+        ITLA_REG_LFL3, ITLA_REG_LFH3, ITLA_REG_LGRID2,
+    };   // no dither (0x59-0x5C): those answer RNI, like most real modules
+    for (uint8_t r : implementedRegs) implemented[r] = true;
+
+    // C-band, 50 GHz grid, 191.3 - 196.1 THz
+    regs[ITLA_REG_GRID] = 500;
+    regs[ITLA_REG_FCF1] = 191;  regs[ITLA_REG_FCF2] = 3000;
+    regs[ITLA_REG_LFL1] = 191;  regs[ITLA_REG_LFL2] = 3000;
+    regs[ITLA_REG_LFH1] = 196;  regs[ITLA_REG_LFH2] = 1000;
+    regs[ITLA_REG_LGRID] = 10;
+    regs[ITLA_REG_OPSL] = 600;  regs[ITLA_REG_OPSH] = 1350;
+    regs[ITLA_REG_FTFR] = 6000;
+    regs[ITLA_REG_POWER] = 1000;
+    regs[ITLA_REG_CHANNEL] = 1;
+    channelCount = (uint32_t)((freqFromRegs(regs[ITLA_REG_LFH1], regs[ITLA_REG_LFH2], 0) -
+                               freqFromRegs(regs[ITLA_REG_FCF1], regs[ITLA_REG_FCF2], 0)) /
+                              gridFromRegs(regs[ITLA_REG_GRID], 0)) + 1;
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), "SIM%08X", (unsigned)(seed & 0xFFFFFFFFu));
+    sn = buf;
+}
+
+FreqMHz SimModule::frequencyOf(uint32_t ch) const {
+    FreqMHz first = freqFromRegs(regs[ITLA_REG_FCF1], regs[ITLA_REG_FCF2], regs[ITLA_REG_FCF3]);
+    return channelFreq(first, gridFromRegs(regs[ITLA_REG_GRID], regs[ITLA_REG_GRID2]), ch);
+}
+
+void SimModule::receive(const uint8_t *frame, long baud, std::function<void(uint8_t, uint64_t)> sink) {
+    // Unplugged, or a rate mismatch: the UART sees framing garbage, no reply
+    if (!present || baud != cfg.baud) return;
+    // Corrupted command: ignored, and the next reply carries CE
+    if (!itlaFrameValid(frame)) {
+        ceNext = true;
+        return;
+    }
+
+    // Injected refusals leave the NOP register alone, so the driver can
+    // still read the error code they set
+    uint8_t status = ITLA_ST_OK;
+    uint16_t data = 0;
+    if (rng.chance(cfg.ceProb)) {
+        ceNext = true;
+    } else if (frame[1] != ITLA_REG_NOP && rng.chance(cfg.xeProb)) {
+        lastErr = ITLA_ERR_EXF;
+        status = ITLA_ST_XE;
+    } else if (frame[1] != ITLA_REG_NOP && rng.chance(cfg.cipProb)) {
+        lastErr = ITLA_ERR_CIP;
+        status = ITLA_ST_XE;
+    } else {
+        data = execute(frame[1], (frame[0] & 0x01) != 0, (uint16_t)((frame[2] << 8) | frame[3]), status);
+    }
+
+    uint8_t out[ITLA_FRAME_LEN] = {
+        (uint8_t)((ceNext ? 0x08 : 0x00) | status), frame[1], (uint8_t)(data >> 8), (uint8_t)data
+    };
+    out[0] |= (uint8_t)(itlaBip4(out[0], out[1], out[2], out[3]) << 4);
+    ceNext = false;
+    answered++;
+    if (rng.chance(cfg.bipProb)) {
+        uint32_t bit = rng.range(0, 8 * ITLA_FRAME_LEN - 1);
+        out[bit / 8] ^= (uint8_t)(1 << (bit % 8));   // BIP-4 catches any single flip
+    }
+
+    uint64_t t = world.nowUs() + (rng.chance(cfg.slowProb) ? rng.range(cfg.slowMinUs, cfg.slowMaxUs)
+                                                          : rng.range(cfg.turnaroundMinUs, cfg.turnaroundMaxUs));
+    uint32_t n = 0;
+    if (rng.chance(cfg.noiseProb)) sink((uint8_t)rng.next(), wireEndUs(t, ++n, baud));
+    int drop = rng.chance(cfg.dropProb) ? (int)rng.range(0, ITLA_FRAME_LEN - 1) : -1;
+    for (int i = 0; i < ITLA_FRAME_LEN; i++) {
+        uint64_t at = wireEndUs(t, ++n, baud);   // a lost byte still took its slot
+        if (i != drop) sink(out[i], at);
+    }
+}
+
+uint16_t SimModule::execute(uint8_t reg, bool write, uint16_t data, uint8_t &status) {
+    bool pending = world.nowUs() < pendingUntil;
+    uint8_t err = ITLA_ERR_OK;
+
+    if (!implemented[reg]) {
+        err = ITLA_ERR_RNI;
+    } else if (write) {
+        switch (reg) {
+        case ITLA_REG_NOP:
+            break;
+        case ITLA_REG_DEV_TYPE: case ITLA_REG_MANUF: case ITLA_REG_MODEL: case ITLA_REG_SN:
+        case ITLA_REG_MFG_DATE: case ITLA_REG_RELEASE: case ITLA_REG_REL_BACK: case ITLA_REG_EAR:
+        case ITLA_REG_LF1: case ITLA_REG_LF2: case ITLA_REG_LF3: case ITLA_REG_OOP: case ITLA_REG_TEMP:
+        case ITLA_REG_FTFR: case ITLA_REG_OPSL: case ITLA_REG_OPSH: case ITLA_REG_LFL1: case ITLA_REG_LFL2:
+        case ITLA_REG_LFL3: case ITLA_REG_LFH1: case ITLA_REG_LFH2: case ITLA_REG_LFH3: case ITLA_REG_LGRID:
+        case ITLA_REG_LGRID2: case ITLA_REG_CURR: case ITLA_REG_TEMPS: case ITLA_REG_AGE:
+            err = ITLA_ERR_RNW;
+            break;
+        case ITLA_REG_CHANNEL: {
+            if (pending) { err = ITLA_ERR_CIP; break; }
+            uint32_t ch = ((uint32_t)regs[ITLA_REG_CHANNELH] << 16) | data;
+            if (ch < 1 || ch > channelCount) { err = ITLA_ERR_RVE; break; }
+            regs[ITLA_REG_CHANNEL] = data;
+            regs[ITLA_REG_FTF] = 0;   // a new channel drops the fine tune
+            fromChannel = channel;
+            channel = ch;
+            tuneUs = rng.range(cfg.tuneMinUs, cfg.tuneMaxUs);
+            pendingUntil = world.nowUs() + tuneUs;
+            break;
+        }
+        case ITLA_REG_CHANNELH: case ITLA_REG_GRID: case ITLA_REG_GRID2:
+        case ITLA_REG_FCF1: case ITLA_REG_FCF2: case ITLA_REG_FCF3:
+            if (pending) err = ITLA_ERR_CIP;
+            else regs[reg] = data;
+            break;
+        case ITLA_REG_POWER:
+            if ((int16_t)data < (int16_t)regs[ITLA_REG_OPSL] || (int16_t)data > (int16_t)regs[ITLA_REG_OPSH])
+                err = ITLA_ERR_RVE;
+            else regs[reg] = data;
+            break;
+        case ITLA_REG_FTF: {
+            int16_t v = (int16_t)data;
+            if ((v < 0 ? -v : v) > (int16_t)regs[ITLA_REG_FTFR]) err = ITLA_ERR_RVE;
+            else regs[reg] = data;
+            break;
+        }
+        default:
+            regs[reg] = data;
+            break;
+        }
+        if (err == ITLA_ERR_OK) data = regs[reg];
+    } else {
+        const char *s = 0;
+        switch (reg) {
+        case ITLA_REG_NOP:
+            data = (uint16_t)((pending ? 0x0100 : 0) | lastErr);
+            lastErr = ITLA_ERR_OK;
+            break;
+        case ITLA_REG_DEV_TYPE: s = AEA_DEV_TYPE; break;
+        case ITLA_REG_MANUF:    s = AEA_MANUF; break;
+        case ITLA_REG_MODEL:    s = AEA_MODEL; break;
+        case ITLA_REG_SN:       s = sn.c_str(); break;
+        case ITLA_REG_MFG_DATE: s = AEA_MFG_DATE; break;
+        case ITLA_REG_RELEASE:
+        case ITLA_REG_REL_BACK: s = AEA_RELEASE; break;
+        case ITLA_REG_EAR:
+            if (!aea || aeaPos >= aeaLen) { err = ITLA_ERR_ERE; break; }
+            data = (uint16_t)((uint8_t)aea[aeaPos] << 8);
+            if (aeaPos + 1 < aeaLen) data |= (uint8_t)aea[aeaPos + 1];
+            aeaPos += 2;
+            break;
+        case ITLA_REG_LF1: case ITLA_REG_LF2: case ITLA_REG_LF3: {
+            // Reads where the laser is: the old channel until the tune completes
+            FreqMHz f = frequencyOf(pending ? fromChannel : channel);
+            if (!pending) f += (int16_t)regs[ITLA_REG_FTF];
+            data = reg == ITLA_REG_LF1 ? freqRegTHz(f) : reg == ITLA_REG_LF2 ? freqRegGHz10(f) : freqRegMHz(f);
+            break;
+        }
+        case ITLA_REG_OOP:
+            data = (regs[ITLA_REG_RESETA] & 0x0008) && !pending ? regs[ITLA_REG_POWER] : (uint16_t)(int16_t)-4000;
+            break;
+        case ITLA_REG_TEMP:
+            data = (uint16_t)(int16_t)(2500 + (int)rng.range(0, 40) - 20);
+            break;
+        default:
+            data = regs[reg];
+            break;
+        }
+        if (s) {
+            aea = s;
+            aeaPos = 0;
+            aeaLen = (uint8_t)strlen(s);
+            status = ITLA_ST_AEA;
+            return aeaLen;
+        }
+    }
+
+    if (err != ITLA_ERR_OK) {
+        lastErr = err;
+        status = ITLA_ST_XE;
+        return 0;
+    }
+    status = ITLA_ST_OK;
+    return data;
+}
+
+// ---------- SimTransport ----------
+
+void SimTransport::begin(long baud) {
+    lineBaud = baud;
+    txLen = 0;
+    rx.clear();
+}
+
+size_t SimTransport::write(const uint8_t *buf, size_t len) {
+    uint64_t start = txFreeUs > world.nowUs() ? txFreeUs : world.nowUs();
+    uint64_t t = start;
+    for (size_t i = 0; i < len; i++) {
+        t = wireEndUs(start, (uint32_t)i + 1, lineBaud);
+        tx[txLen++] = buf[i];
+        if (txLen < ITLA_FRAME_LEN) continue;
+        txLen = 0;
+
+        // The module acts when the last byte is in; its reply bytes are
+        // pushed into the receive ring as each one finishes arriving
+        std::array<uint8_t, ITLA_FRAME_LEN> frame;
+        std::copy(tx, tx + ITLA_FRAME_LEN, frame.begin());
+        long baud = lineBaud;
+        world.at(t, [this, frame, baud]() {
+            module.receive(frame.data(), baud, [this](uint8_t b, uint64_t atUs) {
+                world.at(atUs, [this, b]() { rx.push(b); });
+            });
+        });
+    }
+    txFreeUs = t;
+    return len;
+}
@@ -0,0 +1,238 @@
+// File: host/ITLA_Sim.h
+// Deterministic, in-process simulation of a module on virtual time.
+//   SimWorld      simulated microsecond clock plus a queue of timed events
+//                 (byte deliveries, scenario steps such as "unplug at t")
+//   VirtualClock  Clock policy on the world; every us() poll moves time to
+//                 the next event (at most POLL_QUANTUM_US ahead), sleep() jumps
+//   SimTransport  Transport policy: writes reach the module after their wire
+//                 time at the line's baud, replies land in an RxRing
+//   SimModule     MSA register model at one line rate: pending tunes, CIP/RNI/RVE,
+//                 AEA strings, and seeded faults: jitter and slow replies,
+//                 stray, lost and flipped bytes, CE, XE and CIP refusals
+//   SimHostTime,  the same world and line under a whole sketch: the Arduino
+//   SimSerial     shim's millis()/delay() and a HardwareSerial (host/Arduino.h)
+// Everything random comes from one seeded generator per module, so a seed
+// reproduces a run exactly, and a 100 ms timeout costs well under a
+// millisecond of wall time.
+//
+//   SimWorld world;
+//   SimModule module(world, seed);
+//   SimTransport line(world, module);
+//   SimEventCounts seen;
+//   SimITLA itla(line, VirtualClock(world), SimLogger(&seen));
+//   itla.begin();          // walks the bauds in virtual time
+//
+// Build (from ITLApY/): add host/ITLA_Sim.cpp to the usual host build line.
+#ifndef ITLA_SIM_H
+#define ITLA_SIM_H
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include "ITLA.h"
+#include "ITLA_Frame.h"
+#include "ITLA_RxRing.h"
+
+// Seeded xorshift64*; identical sequences on every host
+class SimRandom {
+public:
+    explicit SimRandom(uint64_t seed) : s(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+    uint64_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 0x2545F4914F6CDD1DULL;
+    }
+    // Uniform in [lo, hi]
+    uint32_t range(uint32_t lo, uint32_t hi) { return lo + (uint32_t)(next() % ((uint64_t)hi - lo + 1)); }
+    bool chance(double p) { return p > 0 && (next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+
+private:
+    uint64_t s;
+};
+
+class SimWorld {
+public:
+    static const uint64_t POLL_QUANTUM_US = 10;    // largest step of one clock poll, about
+                                                   // one pass of a busy-wait loop on the Due
+
+    SimWorld() : now(0), events(0) {}
+
+    uint64_t nowUs() const { return now; }
+    // Run fn when virtual time reaches atUs (same-time events in order added)
+    void at(uint64_t atUs, std::function<void()> fn);
+    // Move time forward by us, running every event that falls due
+    void advance(uint64_t us);
+    // One poll of a busy-waiting caller: to the next event, or a quantum
+    void poll();
+    uint64_t eventsRun() const { return events; }
+
+private:
+    uint64_t now;
+    uint64_t events;
+    std::multimap<uint64_t, std::function<void()>> queue;
+
+    void runUntil(uint64_t t);
+};
+
+// Clock policy for BasicITLA; copies share the world's time
+class VirtualClock {
+public:
+    explicit VirtualClock(SimWorld &w) : world(&w) {}
+    unsigned long ms() const { return (unsigned long)(world->nowUs() / 1000); }
+    unsigned long us() const {
+        world->poll();
+        return (unsigned long)world->nowUs();
+    }
+    void sleep(unsigned long ms) const { world->advance((uint64_t)ms * 1000); }
+
+private:
+    SimWorld *world;
+};
+
+// Clock for observers such as a trace tap: reads virtual time, never moves it
+class SimTimestamp {
+public:
+    explicit SimTimestamp(SimWorld &w) : world(&w) {}
+    unsigned long us() const { return (unsigned long)world->nowUs(); }
+
+private:
+    SimWorld *world;
+};
+
+// Knobs for one simulated module (all times in microseconds)
+struct SimModuleConfig {
+    long baud = 9600;                    // rate the module listens at
+    uint32_t turnaroundMinUs = 200;      // command received -> reply starts
+    uint32_t turnaroundMaxUs = 2000;
+    uint32_t tuneMinUs = 50000;          // CHANNEL write -> pending clear
+    uint32_t tuneMaxUs = 400000;
+    double noiseProb = 0;                // stray byte ahead of a reply
+    double dropProb = 0;                 // one reply byte lost
+    double bipProb = 0;                  // one reply bit flipped (fails BIP)
+    double ceProb = 0;                   // command taken as garbled: not run, reply has CE
+    double xeProb = 0;                   // command refused, XE with EXF in NOP
+    double cipProb = 0;                  // command refused, XE with CIP in NOP
+    double slowProb = 0;                 // turnaround from the slow range instead
+    uint32_t slowMinUs = 5000;
+    uint32_t slowMaxUs = 50000;
+};
+
+class SimModule {
+public:
+    SimModule(SimWorld &world, uint64_t seed, const SimModuleConfig &cfg = SimModuleConfig());
+
+    // A frame's last byte arrived at the module's pins at baud; reply via sink
+    void receive(const uint8_t *frame, long baud, std::function<void(uint8_t, uint64_t)> sink);
+
+    void unplug() { present = false; }
+    void plug() { present = true; }
+    bool plugged() const { return present; }
+
+    const SimModuleConfig &config() const { return cfg; }
+    const std::string &serial() const { return sn; }
+    uint32_t channels() const { return channelCount; }
+    uint64_t lastTuneUs() const { return tuneUs; }   // length of the latest tune
+    uint32_t framesAnswered() const { return answered; }
+
+private:
+    SimWorld &world;
+    SimModuleConfig cfg;
+    SimRandom rng;
+    bool present;
+    uint16_t regs[256];
+    bool implemented[256];
+    std::string sn;
+    const char *aea;       // string being read through EAR
+    uint8_t aeaPos;
+    uint8_t aeaLen;
+    uint8_t lastErr;
+    bool ceNext;
+    uint32_t channelCount;
+    uint32_t channel;      // where the laser is, or is tuning to
+    uint32_t fromChannel;  // where it reads while the tune is pending
+    uint64_t pendingUntil;
+    uint64_t tuneUs;
+    uint32_t answered;
+
+    uint16_t execute(uint8_t reg, bool write, uint16_t data, uint8_t &status);
+    FreqMHz frequencyOf(uint32_t ch) const;   // from FCF and GRID, as the driver computes it
+};
+
+// Transport policy: a serial line between the driver and one SimModule
+class SimTransport {
+public:
+    SimTransport(SimWorld &world, SimModule &module)
+        : world(world), module(module), lineBaud(9600), txLen(0), txFreeUs(0) {}
+
+    void begin(long baud);
+    size_t write(const uint8_t *buf, size_t len);
+    int available() { return rx.available(); }
+    int read() { return rx.read(); }
+
+private:
+    SimWorld &world;
+    SimModule &module;
+    long lineBaud;
+    uint8_t tx[ITLA_FRAME_LEN];
+    uint8_t txLen;
+    uint64_t txFreeUs;        // when the driver's side of the line is idle again
+    RxRing<256> rx;
+};
+
+// Logger events per ID, as seen by one simulated driver
+struct SimEventCounts {
+    uint32_t n[LOG_EVENT_COUNT];
+    SimEventCounts() : n() {}
+    uint32_t operator[](uint8_t id) const { return n[id]; }
+};
+
+// Logger policy: counts into a SimEventCounts owned by the scenario (the
+// driver keeps its own copy of the logger, so the counts live outside it)
+class SimLogger {
+public:
+    explicit SimLogger(SimEventCounts *c = 0) : counts(c) {}
+    void setVerbose(bool) {}
+    void event(uint8_t id, uint8_t = 0, uint16_t = 0, uint32_t = 0) {
+        if (counts && id < LOG_EVENT_COUNT) counts->n[id]++;
+    }
+    void trace(uint8_t, uint8_t = 0, uint16_t = 0, uint32_t = 0) {}
+
+private:
+    SimEventCounts *counts;
+};
+
+// Virtual time for millis()/micros()/delay() (hostUseTime); every reading
+// is a poll, so a sketch's busy-waits move time on as VirtualClock's do
+class SimHostTime : public HostTime {
+public:
+    explicit SimHostTime(SimWorld &w) : world(w) {}
+    uint64_t nowUs() override {
+        world.poll();
+        return world.nowUs();
+    }
+    void sleepUs(uint64_t us) override { world.advance(us); }
+
+private:
+    SimWorld &world;
+};
+
+// A SimTransport as the far end of a HardwareSerial (HardwareSerial::attach),
+// for sketches that drive the module through Serial1
+class SimSerial : public SerialDevice {
+public:
+    explicit SimSerial(SimTransport &line) : line(line) {}
+    void begin(unsigned long baud) override { line.begin((long)baud); }
+    size_t write(const uint8_t *buf, size_t len) override { return line.write(buf, len); }
+    int available() override { return line.available(); }
+    int read() override { return line.read(); }
+
+private:
+    SimTransport &line;
+};
+
+typedef BasicITLA<SimTransport, VirtualClock, SimLogger> SimITLA;
+extern template class BasicITLA<SimTransport, VirtualClock, SimLogger>;
+
+#endif // ITLA_SIM_H
@@ -0,0 +1,113 @@
+// File: host/ITLA_TraceFile.cpp
+#include "ITLA_TraceFile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool TraceFile::open(const char *path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        err = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+        err = std::string(path) + ": too short for a trace";
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // the mapping keeps the file
+    if (p == MAP_FAILED) {
+        err = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+    base = (const uint8_t *)p;
+    bytes = (size_t)st.st_size;
+    const TraceHeader &h = header();
+    if (memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) != 0) {
+        err = std::string(path) + ": not a wire trace";
+        close();
+        return false;
+    }
+    if (h.version != TRACE_VERSION || h.recordSize != sizeof(TraceRecord)) {
+        err = std::string(path) + ": trace version " + std::to_string(h.version) + ", record size " +
+              std::to_string(h.recordSize) + " not supported";
+        close();
+        return false;
+    }
+    madvise(p, bytes, MADV_SEQUENTIAL);
+    records = (bytes - sizeof(TraceHeader)) / sizeof(TraceRecord);
+    return true;
+}
+
+void TraceFile::close() {
+    if (base) munmap((void *)base, bytes);
+    base = 0;
+    bytes = 0;
+    records = 0;
+}
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+long traceConvert(const char *consoleLog, const char *tracePath) {
+    FILE *in = fopen(consoleLog, "r");
+    if (!in) {
+        perror(consoleLog);
+        return -1;
+    }
+    FILE *out = fopen(tracePath, "wb");
+    if (!out) {
+        perror(tracePath);
+        fclose(in);
+        return -1;
+    }
+    TraceHeader h = { TRACE_MAGIC, TRACE_VERSION, sizeof(TraceRecord), 0 };
+    fwrite(&h, sizeof(h), 1, out);
+
+    // Records are whole within a line; a line garbled on the console loses
+    // only its own records, which the seq gap then shows
+    char line[1024];
+    long written = 0, bad = 0;
+    const size_t recHex = 2 * sizeof(TraceRecord);
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] != TRACE_LINE_PREFIX) continue;
+        const char *hex = line + 1;
+        size_t len = strcspn(hex, "\r\n");
+        bool lineBad = len % recHex != 0;
+        for (size_t off = 0; off + recHex <= len; off += recHex) {
+            uint8_t raw[sizeof(TraceRecord)];
+            bool ok = true;
+            for (size_t i = 0; i < sizeof(raw); i++) {
+                int hi = hexNibble(hex[off + 2 * i]), lo = hexNibble(hex[off + 2 * i + 1]);
+                if (hi < 0 || lo < 0) ok = false;
+                raw[i] = (uint8_t)(hi << 4 | lo);
+            }
+            if (!ok) {
+                lineBad = true;
+                break;
+            }
+            fwrite(raw, sizeof(raw), 1, out);
+            written++;
+        }
+        if (lineBad) bad++;
+    }
+    fclose(in);
+    if (fclose(out) != 0) {
+        perror(tracePath);
+        return -1;
+    }
+    if (bad) fprintf(stderr, "%s: %ld malformed trace line(s) skipped\n", consoleLog, bad);
+    return written;
+}
@@ -0,0 +1,70 @@
+// File: host/ITLA_TraceFile.h
+// Read-only view of a binary wire trace (ITLA_Trace.h) through mmap, so
+// multi-hour captures cost page cache rather than heap. Records are used in
+// place; a record cut short at the end of the file (capture stopped
+// mid-write) is left out.
+//   TraceFile t;
+//   if (!t.open("cap.trc")) fprintf(stderr, "%s\n", t.error());
+//   TraceTimeline clock;
+//   for (size_t i = 0; i < t.size(); i++) use(clock.unwrap(t[i]), t[i]);
+#ifndef ITLA_TRACE_FILE_H
+#define ITLA_TRACE_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "ITLA_Trace.h"
+
+class TraceFile {
+public:
+    TraceFile() : base(0), bytes(0), records(0) {}
+    ~TraceFile() { close(); }
+    TraceFile(const TraceFile &) = delete;
+    TraceFile &operator=(const TraceFile &) = delete;
+
+    // false with error() set if the file cannot be mapped or is not a trace
+    bool open(const char *path);
+    void close();
+
+    size_t size() const { return records; }
+    const TraceRecord &operator[](size_t i) const {
+        return ((const TraceRecord *)(base + sizeof(TraceHeader)))[i];
+    }
+    const TraceHeader &header() const { return *(const TraceHeader *)base; }
+    const char *error() const { return err.c_str(); }
+
+private:
+    const uint8_t *base;
+    size_t bytes;
+    size_t records;
+    std::string err;
+};
+
+// Unwraps the 32-bit micros() stamps of records read in file order into
+// microseconds since the first record
+class TraceTimeline {
+public:
+    TraceTimeline() : first(true), last(0), total(0) {}
+    uint64_t unwrap(const TraceRecord &r) {
+        if (first) {
+            first = false;
+            last = r.timeUs;
+            return 0;
+        }
+        total += (uint32_t)(r.timeUs - last);
+        last = r.timeUs;
+        return total;
+    }
+
+private:
+    bool first;
+    uint32_t last;
+    uint64_t total;
+};
+
+// "%" console lines (ITLATrace::drain) -> binary trace with header.
+// Returns the number of records written, or -1 with a message on stderr.
+long traceConvert(const char *consoleLog, const char *tracePath);
+
+#endif // ITLA_TRACE_FILE_H
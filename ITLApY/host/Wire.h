@@ -0,0 +1,18 @@
+// File: host/Wire.h
+// I2C bus stand-in for host builds of the OLED sketch; the display shim
+// (host/Adafruit_SSD1306.h) keeps the frame in memory and never uses it.
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    void begin() {}
+    void setClock(uint32_t hz) { clockHz = hz; }
+    uint32_t clockHz = 100000;
+};
+
+inline TwoWire Wire;
+
+#endif // WIRE_H
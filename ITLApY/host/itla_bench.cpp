@@ -0,0 +1,333 @@
+// File: host/itla_bench.cpp
+// Driver API benchmark against the simulated module (host/ITLA_Sim.h).
+//   itla_bench [-n iterations] [-k passes] [-s seed] [-l label] [-o result.json]
+//              [-c baseline.json [-r percent]]
+// Every operation runs at every baud the driver knows and at three module
+// turnarounds (200, 1000, 5000 us, no jitter):
+//   begin      cold auto-baud from 4800, fresh module and driver each time
+//   read       readRegister(TEMP)
+//   write      writeRegister(POWER)
+//   setfreq    setFrequencyTHz(), alternating between two channels (the
+//              tune itself is waited out untimed)
+//   getfreq    getFrequencyTHz()
+//   aea        readAEAString(SN)
+//   telemetry  the three reads of syncITLA() in ITLAtest: frequency, power,
+//              temperature
+// Two costs per operation:
+//   virtual    link time per call (mean / p50 / p99 / max) and frames per
+//              call: what the protocol and the driver's pacing cost, exact
+//              and the same on any machine for the same seed
+//   host       ns of CPU per call, driver and simulator together: shows
+//              code-path changes. It includes the driver spinning on the
+//              clock while a reply is on its way, so it grows with the link
+//              time. The whole matrix runs -k times (default 3) and the
+//              fastest pass counts, which keeps most of a busy machine's
+//              noise out; expect a few percent all the same
+// -o writes JSON (schema 1, one result per line). -c compares this run with
+// such a file: per operation the change in virtual mean, frames and host
+// ns. The exit status is 1 if any virtual mean or frame count got worse by
+// more than -r percent (default 1); host time is only reported, it is too
+// noisy to gate on.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -Ihost -I. host/itla_bench.cpp host/ITLA_Sim.cpp host/Arduino.cpp
+//       ITLA_.cpp ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp -o itla_bench
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ITLA_Sim.h"
+
+static const int RESULT_SCHEMA = 1;
+static const long BAUDS[] = {4800, 9600, 19200, 38400, 57600, 115200};
+static const uint32_t TURNAROUNDS_US[] = {200, 1000, 5000};
+static const char *const OPS[] = {"begin", "read", "write", "setfreq", "getfreq", "aea", "telemetry"};
+
+struct Result {
+    std::string op;
+    long baud;
+    uint32_t turnaroundUs;
+    uint32_t n;
+    double meanUs;
+    uint64_t p50Us, p99Us, maxUs;
+    double frames;      // per call
+    double hostNs;      // per call
+};
+
+// One timed call: virtual time, frames and host time around fn()
+struct Sampler {
+    SimWorld *world = 0;
+    SimModule *module = 0;
+    std::vector<uint64_t> us = {};
+    uint64_t frames = 0;
+    double hostNs = 0;
+
+    template <class Fn> void operator()(Fn fn) {
+        uint32_t f0 = module->framesAnswered();
+        uint64_t t0 = world->nowUs();
+        auto h0 = std::chrono::steady_clock::now();
+        fn();
+        hostNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - h0).count();
+        us.push_back(world->nowUs() - t0);
+        frames += module->framesAnswered() - f0;
+    }
+
+    Result result(const char *op, long baud, uint32_t turnaround) {
+        Result r = {op, baud, turnaround, (uint32_t)us.size(), 0, 0, 0, 0, 0, 0};
+        if (us.empty()) return r;
+        std::sort(us.begin(), us.end());
+        uint64_t sum = 0;
+        for (uint64_t v : us) sum += v;
+        r.meanUs = (double)sum / us.size();
+        r.p50Us = us[us.size() / 2];
+        r.p99Us = us[std::min(us.size() - 1, us.size() * 99 / 100)];
+        r.maxUs = us.back();
+        r.frames = (double)frames / us.size();
+        r.hostNs = hostNs / us.size();
+        return r;
+    }
+};
+
+static SimModuleConfig moduleConfig(long baud, uint32_t turnaround) {
+    SimModuleConfig cfg;
+    cfg.baud = baud;
+    cfg.turnaroundMinUs = cfg.turnaroundMaxUs = turnaround;
+    return cfg;
+}
+
+static Result benchBegin(long baud, uint32_t turnaround, uint32_t n, uint64_t seed) {
+    Sampler s = {0, 0};
+    for (uint32_t i = 0; i < n; i++) {
+        // A world per run: replies still in flight die with their module
+        SimWorld world;
+        SimModule module(world, seed + i, moduleConfig(baud, turnaround));
+        SimTransport line(world, module);
+        SimITLA itla(line, VirtualClock(world), SimLogger());
+        s.world = &world;
+        s.module = &module;
+        s([&itla]() { itla.begin(); });
+    }
+    return s.result("begin", baud, turnaround);
+}
+
+// Everything but begin on one connected driver
+static void benchConnected(long baud, uint32_t turnaround, uint32_t n, uint64_t seed, std::vector<Result> &out) {
+    SimWorld world;
+    SimModule module(world, seed, moduleConfig(baud, turnaround));
+    SimTransport line(world, module);
+    SimITLA itla(line, VirtualClock(world), SimLogger());
+    if (!itla.begin()) {
+        fprintf(stderr, "no link at %ld baud, turnaround %u us\n", baud, turnaround);
+        return;
+    }
+    ModuleProfile prof;
+    if (itla.readProfile(prof)) itla.useProfile(prof);
+    double thz[2] = {freqToTHz(itla.channelPlan().frequency(1)), freqToTHz(itla.channelPlan().frequency(2))};
+
+    Sampler read = {&world, &module}, write = {&world, &module}, setf = {&world, &module},
+            getf = {&world, &module}, aea = {&world, &module}, telemetry = {&world, &module};
+    for (uint32_t i = 0; i < n; i++) {
+        read([&itla]() { itla.readRegister(ITLA_REG_TEMP); });
+        write([&itla, i]() { itla.writeRegister(ITLA_REG_POWER, (uint16_t)(1000 + (i & 1))); });
+        setf([&itla, &thz, i]() { itla.setFrequencyTHz(thz[i & 1]); });
+        itla.waitPending();
+        getf([&itla]() { itla.getFrequencyTHz(); });
+        aea([&itla]() { itla.readAEAString(ITLA_REG_SN); });
+        telemetry([&itla]() {
+            itla.getFrequencyMHz();
+            itla.getPower();
+            itla.getTemperature();
+        });
+    }
+    out.push_back(read.result("read", baud, turnaround));
+    out.push_back(write.result("write", baud, turnaround));
+    out.push_back(setf.result("setfreq", baud, turnaround));
+    out.push_back(getf.result("getfreq", baud, turnaround));
+    out.push_back(aea.result("aea", baud, turnaround));
+    out.push_back(telemetry.result("telemetry", baud, turnaround));
+}
+
+// ---- JSON ----
+
+static void putJsonString(FILE *f, const char *s) {
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20) fprintf(f, "\\u%04x", *s);
+        else fputc(*s, f);
+    }
+}
+
+static bool writeJson(const char *path, const char *label, uint64_t seed, uint32_t n, uint32_t passes,
+                      const std::vector<Result> &results) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"tool\": \"itla_bench\",\n  \"schema\": %d,\n  \"label\": \"", RESULT_SCHEMA);
+    putJsonString(f, label);
+    fprintf(f, "\",\n  \"seed\": %llu,\n  \"iterations\": %u,\n  \"passes\": %u,\n  \"results\": [\n",
+            (unsigned long long)seed, n, passes);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        fprintf(f, "    {\"op\": \"%s\", \"baud\": %ld, \"turnaround_us\": %u, \"n\": %u, \"virtual_mean_us\": %.1f, "
+                   "\"virtual_p50_us\": %llu, \"virtual_p99_us\": %llu, \"virtual_max_us\": %llu, "
+                   "\"frames\": %.3f, \"host_ns\": %.0f}%s\n",
+                r.op.c_str(), r.baud, r.turnaroundUs, r.n, r.meanUs, (unsigned long long)r.p50Us,
+                (unsigned long long)r.p99Us, (unsigned long long)r.maxUs, r.frames, r.hostNs,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+// Value after "key": on a line of our own output; false if absent
+static bool jsonNumber(const char *line, const char *key, double &v) {
+    std::string k = std::string("\"") + key + "\": ";
+    const char *p = strstr(line, k.c_str());
+    if (!p) return false;
+    v = atof(p + k.size());
+    return true;
+}
+
+static bool jsonString(const char *line, const char *key, std::string &v) {
+    std::string k = std::string("\"") + key + "\": \"";
+    const char *p = strstr(line, k.c_str());
+    if (!p) return false;
+    p += k.size();
+    const char *end = strchr(p, '"');
+    if (!end) return false;
+    v.assign(p, end - p);
+    return true;
+}
+
+static std::string resultKey(const std::string &op, long baud, uint32_t turnaround) {
+    return op + "/" + std::to_string(baud) + "/" + std::to_string(turnaround);
+}
+
+// Reads the results of an itla_bench JSON file (one result per line)
+static bool readBaseline(const char *path, std::map<std::string, Result> &base, std::string &label) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[1024];
+    bool ours = false;
+    while (fgets(line, sizeof(line), f)) {
+        std::string s;
+        double schema;
+        if (jsonString(line, "tool", s)) ours = s == "itla_bench";
+        else if (jsonNumber(line, "schema", schema) && (int)schema != RESULT_SCHEMA) {
+            fprintf(stderr, "%s: schema %d, expected %d\n", path, (int)schema, RESULT_SCHEMA);
+            fclose(f);
+            return false;
+        } else if (jsonString(line, "label", s) && !strstr(line, "\"op\"")) label = s;
+
+        Result r;
+        double baud, turnaround;
+        if (!jsonString(line, "op", r.op) || !jsonNumber(line, "baud", baud) ||
+            !jsonNumber(line, "turnaround_us", turnaround) || !jsonNumber(line, "virtual_mean_us", r.meanUs) ||
+            !jsonNumber(line, "frames", r.frames) || !jsonNumber(line, "host_ns", r.hostNs))
+            continue;
+        r.baud = (long)baud;
+        r.turnaroundUs = (uint32_t)turnaround;
+        base[resultKey(r.op, r.baud, r.turnaroundUs)] = r;
+    }
+    fclose(f);
+    if (!ours) fprintf(stderr, "%s: not an itla_bench result\n", path);
+    return ours;
+}
+
+static double change(double now, double then) { return then > 0 ? 100.0 * (now - then) / then : 0.0; }
+
+// Returns the number of regressions beyond limitPct
+static int compare(const std::vector<Result> &results, const std::map<std::string, Result> &base,
+                   const std::string &label, double limitPct) {
+    printf("\ncompared with %s\n", label.empty() ? "baseline" : label.c_str());
+    printf("%-9s %6s %5s  %10s %8s  %7s %8s  %8s %8s\n", "op", "baud", "turn", "virtual", "change", "frames",
+           "change", "host ns", "change");
+    int worse = 0;
+    size_t matched = 0;
+    for (const Result &r : results) {
+        auto it = base.find(resultKey(r.op, r.baud, r.turnaroundUs));
+        if (it == base.end()) continue;
+        matched++;
+        const Result &b = it->second;
+        double dv = change(r.meanUs, b.meanUs), df = change(r.frames, b.frames), dh = change(r.hostNs, b.hostNs);
+        bool bad = dv > limitPct || df > limitPct;
+        if (bad) worse++;
+        printf("%-9s %6ld %5u  %10.1f %+7.2f%%  %7.3f %+7.2f%%  %8.0f %+7.1f%%%s\n", r.op.c_str(), r.baud,
+               r.turnaroundUs, r.meanUs, dv, r.frames, df, r.hostNs, dh, bad ? "  WORSE" : "");
+    }
+    printf("%zu of %zu results compared, %d worse by more than %.1f%%\n", matched, results.size(), worse, limitPct);
+    return worse;
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n iterations] [-k passes] [-s seed] [-l label] [-o result.json]\n"
+                    "          [-c baseline.json [-r percent]]\n", argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = 200;
+    uint32_t passes = 3;
+    uint64_t seed = 1;
+    const char *label = "";
+    const char *out = 0;
+    const char *baseline = 0;
+    double limitPct = 1.0;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "-n") && hasValue) n = (uint32_t)strtoul(argv[++i], 0, 0);
+        else if (!strcmp(a, "-k") && hasValue) passes = (uint32_t)strtoul(argv[++i], 0, 0);
+        else if (!strcmp(a, "-s") && hasValue) seed = strtoull(argv[++i], 0, 0);
+        else if (!strcmp(a, "-l") && hasValue) label = argv[++i];
+        else if (!strcmp(a, "-o") && hasValue) out = argv[++i];
+        else if (!strcmp(a, "-c") && hasValue) baseline = argv[++i];
+        else if (!strcmp(a, "-r") && hasValue) limitPct = atof(argv[++i]);
+        else return usage(argv[0]);
+    }
+    if (n == 0 || passes == 0) return usage(argv[0]);
+
+    std::map<std::string, Result> base;
+    std::string baseLabel;
+    if (baseline && !readBaseline(baseline, base, baseLabel)) return 2;
+
+    // Virtual numbers are the same on every pass; host time keeps the fastest
+    std::vector<Result> results;
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        std::vector<Result> run;
+        for (long baud : BAUDS)
+            for (uint32_t turnaround : TURNAROUNDS_US) {
+                // begin costs seconds of virtual time at high rates; fewer runs say enough
+                run.push_back(benchBegin(baud, turnaround, std::max(1u, n / 10), seed));
+                benchConnected(baud, turnaround, n, seed, run);
+            }
+        if (pass == 0) results = run;
+        else
+            for (size_t i = 0; i < results.size() && i < run.size(); i++)
+                results[i].hostNs = std::min(results[i].hostNs, run[i].hostNs);
+    }
+
+    printf("%u iterations, %u passes, seed %llu\n", n, passes, (unsigned long long)seed);
+    printf("%-9s %6s %5s  %10s %8s %8s %8s  %7s  %8s\n", "op", "baud", "turn", "mean us", "p50", "p99", "max",
+           "frames", "host ns");
+    for (const char *op : OPS)
+        for (const Result &r : results)
+            if (r.op == op)
+                printf("%-9s %6ld %5u  %10.1f %8llu %8llu %8llu  %7.3f  %8.0f\n", r.op.c_str(), r.baud,
+                       r.turnaroundUs, r.meanUs, (unsigned long long)r.p50Us, (unsigned long long)r.p99Us,
+                       (unsigned long long)r.maxUs, r.frames, r.hostNs);
+
+    if (out && !writeJson(out, label, seed, n, passes, results)) return 1;
+    if (baseline && compare(results, base, baseLabel, limitPct)) return 1;
+    return 0;
+}
@@ -0,0 +1,247 @@
+// File: host/itla_faultbench.cpp
+// Link-layer benchmark under injected faults, on virtual time (host/ITLA_Sim.h).
+//   itla_faultbench [-n transactions] [-s seed] [-b baud] [-t min-max] [-T min-max]
+//                   [-l label] [-o result.json] [fault=rate ...]
+// Faults: none drop noise bip ce xe cip slow (default: each at 1%). "slow" draws
+// the turnaround from -T min-max (default 5000-50000 us) instead of -t.
+// For every fault a fresh module and driver cycle through a TEMP read, a raw
+// POWER write, a TEMP read, and a power change through applyOperatingPoint(),
+// whose writes wait out a CIP refusal and retry (so "cip" costs time where
+// "xe" fails). A lost link is serviced until it comes back, as a sketch would.
+// Reported per fault:
+//   goodput    successful transactions per virtual second, waits included
+//   latency    p50 / p99 / p999 / max of every transaction, failed ones too
+//   recovery   first failure of a streak -> next success (count, p50, p99, max)
+//   events     timeouts, BIP errors, CE flags and resyncs the driver logged
+// -o writes the same numbers as JSON (schema 2) for comparing versions; -l
+// tags the file, e.g. with the git revision under test. Results depend only
+// on the arguments. Exits 1 if a row with nothing injected (none, or a rate
+// of 0) has a failed transaction: on a clean line that is a false timeout.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -Ihost -I. host/itla_faultbench.cpp host/ITLA_Sim.cpp host/Arduino.cpp
+//       ITLA_.cpp ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp -o itla_faultbench
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "ITLA_Sim.h"
+
+static const int RESULT_SCHEMA = 2;   // 2: applyOperatingPoint() in the workload
+
+struct Fault {
+    const char *name;
+    double rate;
+};
+
+struct Percentiles {
+    uint64_t p50, p99, p999, max;
+    size_t count;
+};
+
+struct Result {
+    const char *fault;
+    double rate;
+    uint32_t ok, failed;
+    double seconds;
+    Percentiles latency, recovery;
+    uint32_t timeouts, bipErrors, ce, resyncs;
+};
+
+static Percentiles percentiles(std::vector<uint64_t> &v) {
+    Percentiles p = {0, 0, 0, 0, v.size()};
+    if (v.empty()) return p;
+    std::sort(v.begin(), v.end());
+    auto at = [&v](double q) { return v[std::min(v.size() - 1, (size_t)(q * v.size()))]; };
+    p.p50 = at(0.50);
+    p.p99 = at(0.99);
+    p.p999 = at(0.999);
+    p.max = v.back();
+    return p;
+}
+
+static void setFault(SimModuleConfig &cfg, const Fault &f) {
+    if (!strcmp(f.name, "drop")) cfg.dropProb = f.rate;
+    else if (!strcmp(f.name, "noise")) cfg.noiseProb = f.rate;
+    else if (!strcmp(f.name, "bip")) cfg.bipProb = f.rate;
+    else if (!strcmp(f.name, "ce")) cfg.ceProb = f.rate;
+    else if (!strcmp(f.name, "xe")) cfg.xeProb = f.rate;
+    else if (!strcmp(f.name, "cip")) cfg.cipProb = f.rate;
+    else if (!strcmp(f.name, "slow")) cfg.slowProb = f.rate;
+}
+
+static Result run(const Fault &fault, SimModuleConfig cfg, uint32_t transactions, uint64_t seed) {
+    setFault(cfg, fault);
+    SimWorld world;
+    SimModule module(world, seed, cfg);
+    SimTransport line(world, module);
+    SimEventCounts seen;
+    SimITLA itla(line, VirtualClock(world), SimLogger(&seen));
+
+    Result r = {};
+    r.fault = fault.name;
+    r.rate = fault.rate;
+    std::vector<uint64_t> latency, recovery;
+    latency.reserve(transactions);
+
+    itla.begin();
+    uint32_t channel = ((uint32_t)itla.readRegister(ITLA_REG_CHANNELH) << 16) | itla.readRegister(ITLA_REG_CHANNEL);
+    uint64_t start = world.nowUs();
+    uint64_t failedAt = 0;
+    bool inFailure = false;
+    for (uint32_t i = 0; i < transactions; i++) {
+        // A sketch keeps calling serviceLink() while the link is down
+        while (itla.linkState() == LINK_LOST) {
+            itla.serviceLink();
+            if (itla.linkState() == LINK_LOST) world.advance(10000);
+        }
+
+        uint64_t t0 = world.nowUs();
+        bool ok;
+        if ((i & 3) == 3) {
+            ok = itla.applyOperatingPoint(channel, (i & 4) ? 900 : 1000, ITLA_FTF_UNCHANGED) != 0xFF;
+        } else if (i & 1) {
+            ok = itla.writeRegister(ITLA_REG_POWER, (uint16_t)(800 + (i & 0xFF)));
+        } else {
+            itla.readRegister(ITLA_REG_TEMP);
+            ok = itla.lastStatus() == 0;
+        }
+        latency.push_back(world.nowUs() - t0);
+
+        if (ok) {
+            r.ok++;
+            if (inFailure) recovery.push_back(world.nowUs() - failedAt);
+            inFailure = false;
+        } else {
+            r.failed++;
+            if (!inFailure) failedAt = t0;
+            inFailure = true;
+        }
+    }
+    r.seconds = (world.nowUs() - start) / 1e6;
+    r.latency = percentiles(latency);
+    r.recovery = percentiles(recovery);
+    r.timeouts = seen[LOG_RX_TIMEOUT];
+    r.bipErrors = seen[LOG_BIP_ERROR];
+    r.ce = seen[LOG_CE_FLAG];
+    r.resyncs = itla.rxResyncs();
+    return r;
+}
+
+// JSON string body: quotes, backslashes and control characters escaped
+static void putJsonString(FILE *f, const char *s) {
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20) fprintf(f, "\\u%04x", *s);
+        else fputc(*s, f);
+    }
+}
+
+static bool writeJson(const char *path, const char *label, uint64_t seed, uint32_t transactions,
+                      const SimModuleConfig &cfg, const std::vector<Result> &results) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"tool\": \"itla_faultbench\",\n  \"schema\": %d,\n  \"label\": \"", RESULT_SCHEMA);
+    putJsonString(f, label);
+    fprintf(f, "\",\n");
+    fprintf(f, "  \"seed\": %llu,\n  \"transactions\": %u,\n  \"baud\": %ld,\n", (unsigned long long)seed,
+            transactions, cfg.baud);
+    fprintf(f, "  \"turnaround_us\": [%u, %u],\n  \"slow_us\": [%u, %u],\n  \"results\": [\n", cfg.turnaroundMinUs,
+            cfg.turnaroundMaxUs, cfg.slowMinUs, cfg.slowMaxUs);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        fprintf(f, "    {\"fault\": \"%s\", \"rate\": %g, \"ok\": %u, \"failed\": %u, \"virtual_s\": %.6f, "
+                   "\"goodput_tps\": %.3f,\n", r.fault, r.rate, r.ok, r.failed, r.seconds,
+                r.seconds > 0 ? r.ok / r.seconds : 0.0);
+        fprintf(f, "     \"latency_us\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu},\n",
+                (unsigned long long)r.latency.p50, (unsigned long long)r.latency.p99,
+                (unsigned long long)r.latency.p999, (unsigned long long)r.latency.max);
+        fprintf(f, "     \"recovery_us\": {\"count\": %zu, \"p50\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+                r.recovery.count, (unsigned long long)r.recovery.p50, (unsigned long long)r.recovery.p99,
+                (unsigned long long)r.recovery.max);
+        fprintf(f, "     \"events\": {\"timeouts\": %u, \"bip_errors\": %u, \"ce\": %u, \"resyncs\": %u}}%s\n",
+                r.timeouts, r.bipErrors, r.ce, r.resyncs, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+static bool parseRange(const char *s, uint32_t &lo, uint32_t &hi) {
+    char *end;
+    lo = (uint32_t)strtoul(s, &end, 0);
+    if (*end != '-') return false;
+    hi = (uint32_t)strtoul(end + 1, &end, 0);
+    return *end == '\0' && lo <= hi;
+}
+
+static int usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n transactions] [-s seed] [-b baud] [-t min-max] [-T min-max] [-l label]\n"
+                    "          [-o result.json] [fault=rate ...]\n"
+                    "faults: none drop noise bip ce xe cip slow\n", argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    static const char *const FAULTS[] = {"none", "drop", "noise", "bip", "ce", "xe", "cip", "slow"};
+    uint32_t transactions = 20000;
+    uint64_t seed = 1;
+    const char *label = "";
+    const char *out = 0;
+    SimModuleConfig cfg;
+    cfg.baud = 115200;
+    cfg.turnaroundMinUs = 400;
+    cfg.turnaroundMaxUs = 600;
+    std::vector<Fault> faults;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "-n") && hasValue) transactions = (uint32_t)strtoul(argv[++i], 0, 0);
+        else if (!strcmp(a, "-s") && hasValue) seed = strtoull(argv[++i], 0, 0);
+        else if (!strcmp(a, "-b") && hasValue) cfg.baud = strtol(argv[++i], 0, 0);
+        else if (!strcmp(a, "-t") && hasValue) {
+            if (!parseRange(argv[++i], cfg.turnaroundMinUs, cfg.turnaroundMaxUs)) return usage(argv[0]);
+        } else if (!strcmp(a, "-T") && hasValue) {
+            if (!parseRange(argv[++i], cfg.slowMinUs, cfg.slowMaxUs)) return usage(argv[0]);
+        } else if (!strcmp(a, "-l") && hasValue) label = argv[++i];
+        else if (!strcmp(a, "-o") && hasValue) out = argv[++i];
+        else if (const char *eq = strchr(a, '=')) {
+            Fault f = {0, atof(eq + 1)};
+            for (const char *name : FAULTS)
+                if (strlen(name) == (size_t)(eq - a) && !strncmp(name, a, eq - a)) f.name = name;
+            if (!f.name || f.rate < 0 || f.rate > 1) return usage(argv[0]);
+            faults.push_back(f);
+        } else return usage(argv[0]);
+    }
+    if (transactions == 0 || cfg.baud <= 0) return usage(argv[0]);
+    if (faults.empty())
+        for (const char *name : FAULTS) faults.push_back(Fault{name, strcmp(name, "none") ? 0.01 : 0.0});
+
+    std::vector<Result> results;
+    uint32_t falseFailures = 0;
+    printf("%u transactions per fault, %ld baud, turnaround %u-%u us, seed %llu\n", transactions, cfg.baud,
+           cfg.turnaroundMinUs, cfg.turnaroundMaxUs, (unsigned long long)seed);
+    printf("%-6s %6s %9s %8s  %7s %7s %7s %8s  %6s %8s %8s  %6s %5s %5s %6s\n", "fault", "rate", "goodput/s",
+           "failed", "p50us", "p99us", "p999us", "maxus", "recov", "p50us", "p99us", "tmo", "bip", "ce", "resync");
+    for (const Fault &f : faults) {
+        Result r = run(f, cfg, transactions, seed);
+        results.push_back(r);
+        if (!strcmp(r.fault, "none") || r.rate == 0) falseFailures += r.failed;
+        printf("%-6s %6.4f %9.1f %8u  %7llu %7llu %7llu %8llu  %6zu %8llu %8llu  %6u %5u %5u %6u\n", r.fault, r.rate,
+               r.seconds > 0 ? r.ok / r.seconds : 0.0, r.failed, (unsigned long long)r.latency.p50,
+               (unsigned long long)r.latency.p99, (unsigned long long)r.latency.p999,
+               (unsigned long long)r.latency.max, r.recovery.count, (unsigned long long)r.recovery.p50,
+               (unsigned long long)r.recovery.p99, r.timeouts, r.bipErrors, r.ce, r.resyncs);
+    }
+    if (out && !writeJson(out, label, seed, transactions, cfg, results)) return 1;
+    if (falseFailures) {
+        printf("FAIL: %u failed transaction(s) with no fault injected\n", falseFailures);
+        return 1;
+    }
+    return 0;
+}
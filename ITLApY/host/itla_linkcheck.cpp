@@ -0,0 +1,191 @@
+// File: host/itla_linkcheck.cpp
+// Interleaving checks for the link service (host/ITLA_LinkService.h) against
+// a simulated module (host/ITLA_Sim.h).
+//   itla_linkcheck [seed]
+// Each case starts a readString(SN) and, at the moment its first EAR frame
+// goes out, queues a competing request from the owner thread (a tap on the
+// line), so the competitor is always waiting at the worst point:
+//   string     CONTROL readString(MODEL)
+//   call       CONTROL call() that reads MODEL through the driver
+//   telemetry  TELEMETRY read of MODEL, which starts an AEA transfer
+//   safety-rd  SAFETY read of MODEL: must wait for the string
+//   safety-wr  SAFETY POWER write: may cut in, and must, before the last chunk
+// Two more make the string TELEMETRY, so it shares a window:
+//   tele-2     TELEMETRY readString(MODEL) queued with it, same window
+//   tele-ctl   a TEMP read queued behind it, and a CONTROL readString(MODEL)
+//              at its length read, which the window would run before TEMP
+// Both strings have to come back whole, and the frames on the wire must show
+// each string's EAR chunks back to back (the SAFETY write aside). Exits 1 if
+// any case fails or a reply never comes.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -pthread -Ihost -I. host/itla_linkcheck.cpp host/ITLA_LinkService.cpp
+//       host/ITLA_Sim.cpp host/Arduino.cpp ITLA_.cpp ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp
+//       ITLA_Log.cpp ITLA_Trace.cpp -o itla_linkcheck
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ITLA_LinkService.h"
+#include "ITLA_Sim.h"
+
+// SimSerial that records every command frame the driver sends and calls
+// onFrame(index) as each one completes, on the owner thread
+class TapSerial : public SimSerial {
+public:
+    std::vector<uint8_t> regs;
+    std::vector<bool> writes;
+    std::function<void(size_t)> onFrame;
+
+    explicit TapSerial(SimTransport &line) : SimSerial(line), fill(0) {}
+    size_t write(const uint8_t *buf, size_t len) override {
+        for (size_t i = 0; i < len; i++) {
+            frame[fill++] = buf[i];
+            if (fill < ITLA_FRAME_LEN) continue;
+            fill = 0;
+            regs.push_back(frame[1]);
+            writes.push_back(frame[0] & 0x01);
+            if (onFrame) onFrame(regs.size() - 1);
+        }
+        return SimSerial::write(buf, len);
+    }
+
+private:
+    uint8_t frame[ITLA_FRAME_LEN];
+    uint8_t fill;
+};
+
+enum Competitor { STRING, CALL, TELEMETRY, SAFETY_READ, SAFETY_WRITE, TELE_STRING, TELE_CONTROL };
+
+static const struct {
+    const char *name;
+    Competitor what;
+} CASES[] = {
+    {"string", STRING}, {"call", CALL}, {"telemetry", TELEMETRY},
+    {"safety-rd", SAFETY_READ}, {"safety-wr", SAFETY_WRITE},
+    {"tele-2", TELE_STRING}, {"tele-ctl", TELE_CONTROL},
+};
+
+// A request dropped by the service never resolves; don't hang on it
+template <typename T>
+static bool arrived(std::future<T> &f) {
+    return f.valid() && f.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+}
+
+// The EAR chunks after the first read of reg from frame `from` on: true if
+// all of them come back to back, a SAFETY POWER write aside (counted)
+static bool chunksExclusive(const TapSerial &port, size_t from, uint8_t reg, size_t chars, size_t &cutIn) {
+    size_t i = from;
+    while (i < port.regs.size() && (port.regs[i] != reg || port.writes[i])) i++;
+    size_t chunks = (chars + 1) / 2, seen = 0;
+    for (i++; i < port.regs.size() && seen < chunks; i++) {
+        if (port.regs[i] == ITLA_REG_EAR) seen++;
+        else if (port.writes[i] && port.regs[i] == ITLA_REG_POWER) cutIn++;
+        else break;
+    }
+    return seen == chunks;
+}
+
+static bool runCase(const char *name, Competitor what, uint64_t seed) {
+    SimWorld world;
+    SimModuleConfig cfg;
+    cfg.baud = 115200;
+    cfg.turnaroundMaxUs = 600;
+    SimModule module(world, seed, cfg);
+    SimTransport line(world, module);
+    TapSerial port(line);
+    SimHostTime time(world);
+    Serial1.attach(&port);
+    hostUseTime(&time);
+
+    ITLASerial itlaPort(Serial1);
+    ITLA itla(itlaPort);
+    bool ok = itla.begin();
+    String model = itla.readAEAString(ITLA_REG_MODEL);   // reference, read alone
+    std::string expectModel = model.c_str();
+    std::string expectSn = module.serial();
+
+    LinkService link(itla);
+    std::future<std::string> other;
+    std::future<String> otherCall;
+    std::future<LinkReply> otherReply, temp;
+    bool tele = what == TELE_STRING || what == TELE_CONTROL;
+    bool queued = what == TELE_STRING;
+    size_t from = port.regs.size();
+    // Set before start(), so the owner thread sees it
+    port.onFrame = [&](size_t i) {
+        if (queued || port.regs[i] != (what == TELE_CONTROL ? ITLA_REG_SN : ITLA_REG_EAR)) return;
+        if (what != TELE_CONTROL && (i == 0 || port.regs[i - 1] != ITLA_REG_SN)) return;
+        queued = true;
+        switch (what) {
+            case STRING:       other = link.readString(ITLA_REG_MODEL, PRIO_CONTROL); break;
+            case CALL:         otherCall = link.call([](ITLA &d) { return d.readAEAString(ITLA_REG_MODEL); }); break;
+            case TELEMETRY:    otherReply = link.read(ITLA_REG_MODEL, PRIO_TELEMETRY); break;
+            case SAFETY_READ:  otherReply = link.read(ITLA_REG_MODEL, PRIO_SAFETY); break;
+            case SAFETY_WRITE: otherReply = link.write(ITLA_REG_POWER, 1000, PRIO_SAFETY); break;
+            case TELE_CONTROL: other = link.readString(ITLA_REG_MODEL, PRIO_CONTROL); break;
+            case TELE_STRING:  break;
+        }
+    };
+
+    link.start();
+    // Hold the owner in a call() until everything is queued, so the
+    // TELEMETRY requests land in one window
+    std::promise<void> gate;
+    std::shared_future<void> open = gate.get_future().share();
+    link.call([open](ITLA &) { open.wait(); return 0; });
+    std::future<std::string> snReply = link.readString(ITLA_REG_SN, tele ? PRIO_TELEMETRY : PRIO_BACKGROUND);
+    if (what == TELE_STRING) other = link.readString(ITLA_REG_MODEL, PRIO_TELEMETRY);
+    if (what == TELE_CONTROL) temp = link.read(ITLA_REG_TEMP, PRIO_TELEMETRY);
+    gate.set_value();
+
+    std::string sn = arrived(snReply) ? snReply.get() : "(none)";
+    std::string got = "(none)";
+    switch (what) {
+        case STRING:
+        case TELE_STRING:
+        case TELE_CONTROL:
+            if (arrived(other)) got = other.get();
+            break;
+        case CALL:
+            if (arrived(otherCall)) got = otherCall.get().c_str();
+            break;
+        default:
+            if (arrived(otherReply)) {
+                LinkReply r = otherReply.get();
+                got = r.status == ITLA_ST_OK || r.status == ITLA_ST_AEA ? "ok" : "status " + std::to_string(r.status);
+            }
+            break;
+    }
+    bool tempOk = what != TELE_CONTROL || (arrived(temp) && temp.get().status == ITLA_ST_OK);
+    link.stop();
+    hostUseTime(0);
+    Serial1.attach(0);
+
+    // Each string's frames: its length read, then its EAR chunks; only a
+    // SAFETY write may sit between two of them
+    size_t cutIn = 0;
+    bool exclusive = chunksExclusive(port, from, ITLA_REG_SN, expectSn.size(), cutIn);
+    bool modelString = what != TELEMETRY && what != SAFETY_READ && what != SAFETY_WRITE;
+    if (modelString) exclusive = chunksExclusive(port, from, ITLA_REG_MODEL, expectModel.size(), cutIn) && exclusive;
+    std::string expectOther = modelString ? expectModel : "ok";
+
+    ok = ok && queued && sn == expectSn && got == expectOther && tempOk && exclusive &&
+         (what != SAFETY_WRITE || cutIn == 1);
+    printf("%-10s %-4s sn '%s' other '%s' frames %s%s\n", name, ok ? "ok" : "FAIL", sn.c_str(), got.c_str(),
+           exclusive ? "exclusive" : "interleaved", what == SAFETY_WRITE ? (cutIn ? ", write cut in" : ", write waited") : "");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], 0, 0) : 1;
+    int failed = 0;
+    for (const auto &c : CASES) {
+        if (!runCase(c.name, c.what, seed)) failed++;
+    }
+    printf("%d of %zu cases failed\n", failed, sizeof(CASES) / sizeof(CASES[0]));
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+// File: host/itla_logdecode.cpp
+// Turns the driver's deferred log (ITLA_Log.h) back into text.
+//   itla_logdecode < capture.txt        or        itla_logdecode /dev/ttyACM0
+// Lines starting with '~' are decoded with the format table from
+// ITLA_LogEvents.def; everything else (JSON telemetry, command replies) is
+// passed through unchanged, so the output reads as one timeline.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -Ihost -I. host/itla_logdecode.cpp -o itla_logdecode
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ITLA_Log.h"
+
+static const char *const EVENT_NAMES[] = {
+#define ITLA_LOG_EVENT(name, format) #name,
+#include "ITLA_LogEvents.def"
+#undef ITLA_LOG_EVENT
+};
+
+static const char *const EVENT_FORMATS[] = {
+#define ITLA_LOG_EVENT(name, format) format,
+#include "ITLA_LogEvents.def"
+#undef ITLA_LOG_EVENT
+};
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Expand "%<n>$<spec>" with argument n (1-based) of args; other text as is
+static void format(const char *fmt, const uint32_t args[3], FILE *out) {
+    for (const char *p = fmt; *p; p++) {
+        if (p[0] != '%' || p[1] < '1' || p[1] > '3' || p[2] != '$') {
+            fputc(*p, out);
+            continue;
+        }
+        uint32_t v = args[p[1] - '1'];
+        char spec[16] = "%";
+        size_t n = 1;
+        p += 3;
+        while (*p && n < sizeof(spec) - 2 && !strchr("uxXd", *p)) spec[n++] = *p++;
+        if (!*p) break;
+        spec[n++] = *p;
+        spec[n] = '\0';
+        fprintf(out, spec, (unsigned)v);
+    }
+}
+
+static void decodeLine(const char *hex, uint32_t &lastUs, bool &haveLast) {
+    size_t len = strlen(hex);
+    while (len && (hex[len - 1] == '\r' || hex[len - 1] == '\n')) len--;
+    const size_t recHex = 2 * sizeof(LogRecord);
+    for (size_t off = 0; off + recHex <= len; off += recHex) {
+        uint8_t raw[sizeof(LogRecord)];
+        bool ok = true;
+        for (size_t i = 0; i < sizeof(LogRecord); i++) {
+            int hi = hexNibble(hex[off + 2 * i]), lo = hexNibble(hex[off + 2 * i + 1]);
+            if (hi < 0 || lo < 0) ok = false;
+            raw[i] = (uint8_t)(hi << 4 | lo);
+        }
+        if (!ok) {
+            printf("[log] malformed record\n");
+            return;
+        }
+        LogRecord r;
+        memcpy(&r, raw, sizeof(r));
+
+        uint32_t delta = haveLast ? r.timeUs - lastUs : 0;
+        lastUs = r.timeUs;
+        haveLast = true;
+        printf("[log %10.6f +%7u us] ", r.timeUs / 1e6, delta);
+        if (r.event >= LOG_EVENT_COUNT) {
+            printf("event %u: %u %u %u\n", r.event, r.a, r.b, r.c);
+            continue;
+        }
+        uint32_t args[3] = { r.a, r.b, r.c };
+        printf("%s: ", EVENT_NAMES[r.event]);
+        format(EVENT_FORMATS[r.event], args, stdout);
+        putchar('\n');
+    }
+}
+
+int main(int argc, char **argv) {
+    FILE *in = stdin;
+    if (argc > 1 && !(in = fopen(argv[1], "r"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    char line[1024];
+    uint32_t lastUs = 0;
+    bool haveLast = false;
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == LOG_LINE_PREFIX) decodeLine(line + 1, lastUs, haveLast);
+        else fputs(line, stdout);
+        fflush(stdout);
+    }
+    return 0;
+}
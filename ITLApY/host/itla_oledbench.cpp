@@ -0,0 +1,243 @@
+// File: host/itla_oledbench.cpp
+// The OLED controller sketch (ITLA_OLED_Controller.cpp) run on a host: its
+// setup() and loop() unchanged, on simulated time, with the module simulated
+// on Serial1 (host/ITLA_Sim.h), the panel in memory (host/Adafruit_SSD1306.h)
+// and the buttons pressed through their pins, so debounce, auto-repeat and
+// live apply run as they do on the Due.
+//   itla_oledbench [-s seed] [-d dir] [-g golden_dir] [-v] [script...]
+// A script is a list of steps (the default tours every screen):
+//   up down inc dec ok   press for 60 ms, then 250 ms idle
+//   inc:3000             hold for 3000 ms (auto-repeat), then 250 ms idle
+//   wait:1500            idle
+//   shot:name            end of a segment: print what the frames since the
+//                        previous shot cost, then save the panel as
+//                        dir/name.pbm (-d) and/or compare it with
+//                        golden_dir/name.pbm (-g)
+// Per segment: frames flushed, pixels touched and changed, glyphs, frame
+// bytes that changed (what a dirty-column flush would send), I2C bytes and
+// bus ms of the full-frame flushes at 400 kHz, host us of rendering and the
+// virtual ms the sketch spent in displayCurrentMenu(), flush and any ITLA
+// reads of the screen included. Everything but host us is exact for a
+// seed. The exit status is 1 if a golden image differs or is missing.
+// -v passes the sketch's console output through (boot timeline, log).
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -Ihost -I. host/itla_oledbench.cpp ITLA_OLED_Controller.cpp
+//       host/Adafruit_GFX.cpp host/Adafruit_SSD1306.cpp host/ITLA_Sim.cpp host/Arduino.cpp
+//       ITLA_.cpp ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp
+//       ITLA_Buttons.cpp ITLA_ConfigStore.cpp ITLA_Presets.cpp ITLA_Profile.cpp
+//       ITLA_LiveApply.cpp ITLA_LoopProfiler.cpp ITLA_BootTrace.cpp -o itla_oledbench
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include <Adafruit_SSD1306.h>
+
+#include "ITLA_Sim.h"
+#include "ITLA_LoopProfiler.h"
+
+// From the sketch
+void setup();
+void loop();
+extern Adafruit_SSD1306 display;
+extern uint8_t secDisplay;
+
+// The sketch's button pins (BUTTON_*_PIN)
+static const struct {
+    const char *name;
+    uint8_t pin;
+} BUTTONS[] = {{"up", 2}, {"down", 3}, {"inc", 4}, {"dec", 5}, {"ok", 6}};
+
+static const unsigned long PRESS_MS = 60;
+static const unsigned long IDLE_MS = 250;
+
+static const char *const DEFAULT_SCRIPT[] = {
+    "shot:main",
+    "down", "down", "down", "down", "down", "down", "shot:main_scrolled",
+    "up", "up", "up", "up", "up", "up",
+    "ok", "shot:device_info", "up",
+    "down", "ok", "shot:laser", "ok", "shot:laser_toggle", "up",
+    "down", "down", "ok", "shot:power", "inc", "inc", "shot:power_inc", "dec:2500", "shot:power_held",
+    "ok", "shot:power_set", "up",
+    "down", "down", "down", "ok", "shot:freq", "inc", "shot:freq_inc", "inc:4500", "shot:freq_held",
+    "ok", "shot:freq_set", "up",
+    "down", "down", "down", "down", "ok", "wait:2500", "shot:temperature", "up",
+    "down", "down", "down", "down", "down", "ok", "wait:2500", "shot:status", "up",
+    "down", "down", "down", "down", "down", "down", "ok", "shot:advanced", "ok", "shot:advanced_live", "up",
+    "down", "down", "down", "ok", "inc:1200", "wait:1500", "shot:freq_live", "up",
+    "up", "ok", "shot:presets", "down", "down", "shot:presets_2", "up",
+};
+
+// Console stand-in: the sketch's USB output, counted and dropped
+class NullConsole : public SerialDevice {
+public:
+    uint64_t bytes = 0;
+    void begin(unsigned long) override {}
+    size_t write(const uint8_t *, size_t len) override {
+        bytes += len;
+        return len;
+    }
+    int available() override { return 0; }
+    int read() override { return -1; }
+};
+
+struct Bench {
+    SimWorld &world;
+    const char *dumpDir = 0;
+    const char *goldenDir = 0;
+    FramebufferStats last = FramebufferStats();
+    uint64_t lastDisplayTicks = 0;
+    int goldenBad = 0;
+
+    explicit Bench(SimWorld &w) : world(w) {}
+
+    // loop() at about 1 kHz for ms of virtual time
+    void run(unsigned long ms) {
+        uint64_t end = world.nowUs() + (uint64_t)ms * 1000;
+        while (world.nowUs() < end) {
+            loop();
+            delay(1);
+        }
+    }
+
+    void press(uint8_t pin, unsigned long holdMs) {
+        hostDriveInput(pin, LOW);
+        run(holdMs);
+        hostDriveInput(pin, HIGH);
+        run(IDLE_MS);
+    }
+
+    void shot(const std::string &name) {
+        FramebufferStats s = display.stats();
+        const LoopStats &d = loopProfiler.stats(secDisplay);
+        uint64_t frames = s.frames - last.frames;
+        uint64_t busBytes = s.busBytes - last.busBytes;
+        uint64_t transactions = s.transactions - last.transactions;
+        printf("%-22s %6llu %9llu %9llu %7llu %8llu %8llu %8.1f %9.1f %9.1f\n", name.c_str(),
+               (unsigned long long)frames, (unsigned long long)(s.pixelsTouched - last.pixelsTouched),
+               (unsigned long long)(s.pixelsChanged - last.pixelsChanged),
+               (unsigned long long)(s.glyphs - last.glyphs), (unsigned long long)(s.dirtyBytes - last.dirtyBytes),
+               (unsigned long long)busBytes, display.busUs(busBytes, transactions) / 1000.0,
+               (s.renderNs - last.renderNs) / 1000.0, (d.sumTicks - lastDisplayTicks) / 1000.0);
+        last = s;
+        lastDisplayTicks = d.sumTicks;
+
+        std::string file = name + ".pbm";
+        if (dumpDir && !display.savePbm((std::string(dumpDir) + "/" + file).c_str())) {
+            fprintf(stderr, "%s/%s: cannot write\n", dumpDir, file.c_str());
+        }
+        if (goldenDir) {
+            int differ = display.comparePbm((std::string(goldenDir) + "/" + file).c_str());
+            if (differ != 0) {
+                goldenBad++;
+                if (differ < 0) fprintf(stderr, "golden %s: missing or not a %dx%d P4 image\n", file.c_str(),
+                                        display.width(), display.height());
+                else fprintf(stderr, "golden %s: %d rows differ\n", file.c_str(), differ);
+            }
+        }
+    }
+
+    bool step(const std::string &s) {
+        std::string verb = s, arg;
+        size_t colon = s.find(':');
+        if (colon != std::string::npos) {
+            verb = s.substr(0, colon);
+            arg = s.substr(colon + 1);
+        }
+        if (verb == "shot" && !arg.empty()) {
+            shot(arg);
+            return true;
+        }
+        if (verb == "wait" && !arg.empty()) {
+            run(strtoul(arg.c_str(), 0, 0));
+            return true;
+        }
+        for (const auto &b : BUTTONS) {
+            if (verb != b.name) continue;
+            press(b.pin, arg.empty() ? PRESS_MS : strtoul(arg.c_str(), 0, 0));
+            return true;
+        }
+        return false;
+    }
+};
+
+static int usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-s seed] [-d dir] [-g golden_dir] [-v] [script...]\n", argv0);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    uint64_t seed = 1;
+    const char *dumpDir = 0;
+    const char *goldenDir = 0;
+    bool verbose = false;
+    std::vector<std::string> script;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "-s") && hasValue) seed = strtoull(argv[++i], 0, 0);
+        else if (!strcmp(a, "-d") && hasValue) dumpDir = argv[++i];
+        else if (!strcmp(a, "-g") && hasValue) goldenDir = argv[++i];
+        else if (!strcmp(a, "-v")) verbose = true;
+        else if (a[0] == '-') return usage(argv[0]);
+        else script.push_back(a);
+    }
+    if (script.empty()) script.assign(std::begin(DEFAULT_SCRIPT), std::end(DEFAULT_SCRIPT));
+
+    // A fresh store every run: presets and profiles start empty
+    char store[64];
+    snprintf(store, sizeof(store), "/tmp/itla_oledbench.%d.bin", (int)getpid());
+    unlink(store);
+    setenv("ITLA_CONFIG_FILE", store, 1);
+
+    SimWorld world;
+    SimModuleConfig cfg;
+    cfg.turnaroundMaxUs = 1000;
+    SimModule module(world, seed, cfg);
+    SimTransport line(world, module);
+    SimSerial port(line);
+    SimHostTime time(world);
+    NullConsole console;
+    Serial1.attach(&port);
+    if (!verbose) Serial.attach(&console);
+    hostUseTime(&time);
+    display.setBusTiming(true);
+
+    Bench bench(world);
+    bench.dumpDir = dumpDir;
+    bench.goldenDir = goldenDir;
+
+    setup();
+    printf("seed %llu, module %s, up after %.1f ms (virtual)\n", (unsigned long long)seed,
+           module.serial().c_str(), world.nowUs() / 1000.0);
+    printf("%-22s %6s %9s %9s %7s %8s %8s %8s %9s %9s\n", "segment", "frames", "px touch", "px change", "glyphs",
+           "dirty B", "I2C B", "bus ms", "render us", "disp ms");
+    bench.shot("setup");
+
+    for (const std::string &s : script) {
+        if (!bench.step(s)) {
+            fprintf(stderr, "bad step '%s'\n", s.c_str());
+            unlink(store);
+            return 2;
+        }
+    }
+
+    FramebufferStats t = display.stats();
+    printf("total: %llu frames, %llu I2C bytes (%.1f ms of bus), %llu of %llu frame bytes changed (%.1f%%), "
+           "%.1f s virtual, %llu module frames\n",
+           (unsigned long long)t.frames, (unsigned long long)t.busBytes,
+           display.busUs(t.busBytes, t.transactions) / 1000.0, (unsigned long long)t.dirtyBytes,
+           (unsigned long long)(t.frames * display.width() * display.height() / 8),
+           t.frames ? 100.0 * t.dirtyBytes / (t.frames * display.width() * display.height() / 8) : 0.0,
+           world.nowUs() / 1e6, (unsigned long long)module.framesAnswered());
+    if (goldenDir) printf("golden: %d image(s) differ\n", bench.goldenBad);
+
+    hostUseTime(0);
+    Serial.attach(0);
+    Serial1.attach(0);
+    unlink(store);
+    return bench.goldenBad ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+// File: host/itla_simrun.cpp
+// Seeded connect / retune / timeout scenarios against simulated modules, all
+// on virtual time (host/ITLA_Sim.h).
+//   itla_simrun [runs] [seed]
+// Each run gets its own module (random baud, turnaround and tune times) and
+// driver, and goes through:
+//   connect  auto-baud from 4800 up until the module answers
+//   retune   read the profile, then three random channels: tune, wait for
+//            pending, check LF against the channel plan
+//   timeout  unplug mid-polling, count the timeouts until LINK_LOST, plug it
+//            back in and time serviceLink() until the link is healthy
+//   noisy    every fourth run: stray and lost reply bytes on a burst of reads
+// Outcomes: "failed" means the driver reported an error (a timeout, a CIP
+// after a missed reply); "wrong" means it reported success with the module in
+// another state, or never got there. Only the noisy line injects faults, so
+// only there is a failure expected; connect and retune run on a healthy line
+// and a failure there is a false timeout, i.e. a bug.
+// The same seed gives the same output line for line, including the virtual
+// times and the final checksum; only the wall time line differs. Exits 1 if
+// anything came out wrong or connect/retune failed.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -Ihost -I. host/itla_simrun.cpp host/ITLA_Sim.cpp host/Arduino.cpp
+//       ITLA_.cpp ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp -o itla_simrun
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "ITLA_Sim.h"
+
+static const long BAUDS[] = {4800, 9600, 19200, 38400, 57600, 115200};
+
+enum Outcome { OK, FAILED, WRONG };
+
+struct Stat {
+    const char *name = "";
+    uint32_t n[3] = {0, 0, 0};
+    uint64_t totalUs = 0, maxUs = 0;
+
+    void add(Outcome o, uint64_t us) {
+        n[o]++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+    void print() const {
+        uint32_t all = n[OK] + n[FAILED] + n[WRONG];
+        printf("%-8s %6u ok %5u failed %3u wrong   virtual mean %9.3f ms  max %9.3f ms\n", name,
+               n[OK], n[FAILED], n[WRONG], all ? totalUs / 1000.0 / all : 0.0, maxUs / 1000.0);
+    }
+};
+
+// Errors the driver reported through its logger so far
+static uint32_t errorsSeen(const SimEventCounts &seen) {
+    return seen[LOG_RX_TIMEOUT] + seen[LOG_BIP_ERROR] + seen[LOG_CE_FLAG] + seen[LOG_READ_ERROR];
+}
+
+// FNV-1a over every measured time: equal for equal runs
+static uint64_t checksum = 0xcbf29ce484222325ULL;
+static void mix(uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        checksum ^= (uint8_t)(v >> (8 * i));
+        checksum *= 0x100000001b3ULL;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t runs = argc > 1 ? (uint32_t)strtoul(argv[1], 0, 0) : 1000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], 0, 0) : 1;
+
+    Stat connect = {"connect"}, retune = {"retune"}, lost = {"lost"}, reacq = {"reacq"}, noisy = {"noisy"};
+    uint64_t virtualUs = 0, events = 0;
+    uint32_t timeouts = 0, resyncs = 0;
+    SimRandom scenario(seed);
+    auto wall0 = std::chrono::steady_clock::now();
+
+    for (uint32_t run = 0; run < runs; run++) {
+        SimModuleConfig cfg;
+        cfg.baud = BAUDS[scenario.range(0, 5)];
+        uint32_t turnaround = scenario.range(100, 1500);   // +-5% jitter around it
+        cfg.turnaroundMinUs = turnaround * 19 / 20;
+        cfg.turnaroundMaxUs = turnaround * 21 / 20;
+        bool withNoise = run % 4 == 3;
+
+        SimWorld world;
+        SimModule module(world, scenario.next(), cfg);
+        SimTransport line(world, module);
+        SimEventCounts seen;
+        SimITLA itla(line, VirtualClock(world), SimLogger(&seen));
+
+        // connect
+        uint64_t t0 = world.nowUs();
+        bool ok = itla.begin();
+        connect.add(ok ? OK : FAILED, world.nowUs() - t0);
+        mix(world.nowUs());
+        if (!ok) continue;
+
+        // retune
+        ModuleProfile prof;
+        if (!itla.readProfile(prof)) {
+            retune.add(FAILED, 0);
+            continue;
+        }
+        if (module.serial() != prof.serial) {
+            retune.add(WRONG, 0);
+            continue;
+        }
+        itla.useProfile(prof);
+        for (int i = 0; i < 3; i++) {
+            uint32_t ch = scenario.range(1, module.channels());
+            t0 = world.nowUs();
+            // waitPending() also ends on a failed poll; lastStatus() tells
+            ok = itla.setChannel(ch) && itla.waitPending(SimITLA::PENDING_TIMEOUT_MS) && itla.lastStatus() == 0;
+            uint64_t took = world.nowUs() - t0;
+            Outcome o = FAILED;
+            if (ok) {
+                // three reads; lastStatus() would only cover the last one
+                uint32_t errors = errorsSeen(seen);
+                FreqMHz lf = itla.getFrequencyLFMHz();
+                if (errorsSeen(seen) != errors) o = FAILED;
+                else o = took >= module.lastTuneUs() && lf == itla.channelPlan().frequency(ch) ? OK : WRONG;
+            }
+            retune.add(o, took);
+            mix(took);
+        }
+
+        // noisy line: the driver has to resync; reads may fail but must not hang
+        if (withNoise) {
+            SimModuleConfig noisyCfg = cfg;
+            noisyCfg.noiseProb = 0.05;
+            noisyCfg.dropProb = 0.05;
+            SimModule noisyModule(world, scenario.next(), noisyCfg);
+            SimTransport noisyLine(world, noisyModule);
+            SimEventCounts noisySeen;
+            SimITLA noisyItla(noisyLine, VirtualClock(world), SimLogger(&noisySeen));
+            if (noisyItla.begin()) {
+                for (int i = 0; i < 50; i++) {
+                    t0 = world.nowUs();
+                    uint16_t v = noisyItla.readRegister(ITLA_REG_GRID);
+                    Outcome o = noisyItla.lastStatus() != 0 ? FAILED : v == 500 ? OK : WRONG;
+                    noisy.add(o, world.nowUs() - t0);
+                    noisyItla.serviceLink();
+                }
+            } else {
+                noisy.add(FAILED, 0);
+            }
+            resyncs += noisyItla.rxResyncs();
+            timeouts += noisySeen[LOG_RX_TIMEOUT];
+        }
+
+        // timeout: module goes away somewhere in the next 200 ms of polling
+        uint32_t timeoutsBefore = seen[LOG_RX_TIMEOUT];
+        uint64_t unplugAt = world.nowUs() + scenario.range(0, 200000);
+        world.at(unplugAt, [&module]() { module.unplug(); });
+        uint64_t deadline = unplugAt + 10000000;
+        while (itla.linkState() != LINK_LOST && world.nowUs() < deadline) {
+            itla.getTemperature();
+            world.advance(10000);
+        }
+        ok = itla.linkState() == LINK_LOST &&
+             seen[LOG_RX_TIMEOUT] - timeoutsBefore >= SimITLA::LOST_AFTER_FAILURES;
+        lost.add(ok ? OK : WRONG, world.nowUs() - unplugAt);
+        timeouts += seen[LOG_RX_TIMEOUT];
+
+        uint64_t plugAt = world.nowUs() + scenario.range(500000, 3000000);
+        world.at(plugAt, [&module]() { module.plug(); });
+        deadline = plugAt + 30000000;
+        while (itla.linkState() != LINK_HEALTHY && world.nowUs() < deadline) {
+            itla.serviceLink();
+            world.advance(10000);
+        }
+        reacq.add(itla.linkState() == LINK_HEALTHY ? OK : WRONG, world.nowUs() - plugAt);
+        mix(world.nowUs());
+
+        virtualUs += world.nowUs();
+        events += world.eventsRun();
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    printf("runs %u  seed %llu\n", runs, (unsigned long long)seed);
+    connect.print();
+    retune.print();
+    lost.print();
+    reacq.print();
+    noisy.print();
+    printf("timeouts %u  resyncs %u  events %llu\n", timeouts, resyncs, (unsigned long long)events);
+    printf("virtual %.3f s  checksum %016llx\n", virtualUs / 1e6, (unsigned long long)checksum);
+    printf("wall %.3f s\n", wall);
+    uint32_t wrong = connect.n[WRONG] + retune.n[WRONG] + lost.n[WRONG] + reacq.n[WRONG] + noisy.n[WRONG];
+    uint32_t falseFailures = connect.n[FAILED] + retune.n[FAILED];
+    if (falseFailures) printf("FAIL: %u failure(s) with no fault injected\n", falseFailures);
+    return wrong || falseFailures ? 1 : 0;
+}
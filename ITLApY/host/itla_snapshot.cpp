@@ -0,0 +1,82 @@
+// File: host/itla_snapshot.cpp
+// Capture and compare full register snapshots (ITLA_Snapshot.h images).
+//   itla_snapshot take <out.snap> [previous.snap]   module on $ITLA_PORT
+//   itla_snapshot diff <a.snap> <b.snap>
+//   itla_snapshot show <file.snap>
+// take seeds the RNI set from previous (if given and the same module), so
+// registers the module does not implement are not asked for again, then
+// prints what changed since it.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -Ihost -I. host/itla_snapshot.cpp host/Arduino.cpp ITLA_.cpp
+//       ITLA_ChannelPlan.cpp ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp ITLA_Snapshot.cpp
+//       -o itla_snapshot
+#include <stdio.h>
+
+#include "ITLA.h"
+#include "ITLA_Snapshot.h"
+
+static bool loadImage(const char *path, Snapshot &s) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    bool ok = fread(&s, sizeof(s), 1, f) == 1 && s.version == SNAPSHOT_VERSION;
+    fclose(f);
+    if (!ok) fprintf(stderr, "%s: not a version %d snapshot\n", path, SNAPSHOT_VERSION);
+    return ok;
+}
+
+static bool saveImage(const char *path, const Snapshot &s) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    bool ok = fwrite(&s, sizeof(s), 1, f) == 1;
+    return fclose(f) == 0 && ok;
+}
+
+static int take(const char *out, const char *previous) {
+    Snapshot prev;
+    bool havePrev = previous && loadImage(previous, prev);
+    if (previous && !havePrev) return 1;
+
+    ITLASerial port(Serial1);
+    ITLA itla(port);
+    if (!itla.begin()) {
+        fprintf(stderr, "no module on $ITLA_PORT\n");
+        return 1;
+    }
+    // Serial number keys the RNI set
+    ModuleProfile p;
+    if (itla.readProfile(p)) itla.useProfile(p);
+    if (havePrev) snapshots.learn(prev);
+
+    Snapshot s;
+    uint8_t n = snapshots.take(itla, s);
+    if (!saveImage(out, s)) return 1;
+    printf("%u registers in %u ms\n", n, s.durationMs);
+    if (havePrev) diffSnapshots(prev, s, Serial);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "take") == 0) {
+        return take(argv[2], argc > 3 ? argv[3] : 0);
+    }
+    if (argc == 4 && strcmp(argv[1], "diff") == 0) {
+        Snapshot a, b;
+        if (!loadImage(argv[2], a) || !loadImage(argv[3], b)) return 1;
+        return diffSnapshots(a, b, Serial) ? 1 : 0;
+    }
+    if (argc == 3 && strcmp(argv[1], "show") == 0) {
+        Snapshot s;
+        if (!loadImage(argv[2], s)) return 1;
+        printSnapshot(s, Serial);
+        return 0;
+    }
+    fprintf(stderr, "usage: %s take <out> [previous] | diff <a> <b> | show <file>\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,51 @@
+// File: host/itla_sweep.cpp
+// Channel sweep over any number of modules from one thread.
+//   itla_sweep <first> <last> <port> [port...]
+// Each port gets its own coroutine: auto-baud, then for every channel tune,
+// wait for the pending flag and print LF and temperature.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -pthread -Ihost -I. host/itla_sweep.cpp host/ITLA_Async.cpp
+//       host/ITLA_LinkService.cpp host/Arduino.cpp ITLA_.cpp ITLA_ChannelPlan.cpp
+//       ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp -o itla_sweep
+#include <stdio.h>
+#include <memory>
+
+#include "ITLA_Async.h"
+
+static Task<void> sweep(AsyncITLA &itla, uint32_t first, uint32_t last) {
+    if (!co_await itla.begin()) {
+        printf("%s: no response\n", itla.name().c_str());
+        co_return;
+    }
+    for (uint32_t ch = first; ch <= last; ch++) {
+        if (!co_await itla.tune(ch)) {
+            printf("%s: ch %u failed\n", itla.name().c_str(), ch);
+            co_return;
+        }
+        LinkReply lf1 = co_await itla.read(Reg::LF1);
+        LinkReply lf2 = co_await itla.read(Reg::LF2);
+        LinkReply lf3 = co_await itla.read(Reg::LF3);
+        LinkReply temp = co_await itla.read(Reg::Temp);
+        printf("%s: ch %u  %.6f THz  %.2f C\n", itla.name().c_str(), ch,
+               freqToTHz(freqFromRegs(lf1.value, lf2.value, lf3.value)), (int16_t)temp.value / 100.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <first> <last> <port> [port...]\n", argv[0]);
+        return 2;
+    }
+    uint32_t first = strtoul(argv[1], 0, 10);
+    uint32_t last = strtoul(argv[2], 0, 10);
+
+    EpollExecutor ex;
+    std::vector<std::unique_ptr<AsyncITLA>> ports;
+    for (int i = 3; i < argc; i++) {
+        ports.emplace_back(new AsyncITLA(ex, argv[i]));
+        ex.spawn(sweep(*ports.back(), first, last));
+    }
+    ex.run();
+    return 0;
+}
@@ -0,0 +1,527 @@
+// File: host/itla_trace.cpp
+// Wire traces (ITLA_Trace.h): convert, inspect, record in the simulator and
+// replay into the driver or the simulator.
+//   itla_trace convert <console.log> <out.trc>
+//       '%' lines captured from ITLAtest (TRACE_ON) -> binary trace
+//   itla_trace dump <trace>
+//       one line per record: time since start, delta, kind, bytes; decoded
+//       frames for TX/RX, and seq gaps where the ring dropped records
+//   itla_trace record <out.trc> [-s seed] [-n operations] [fault=rate ...]
+//       a simulated session (host/ITLA_Sim.h) captured through
+//       TracingTransport, as ITLAtest would capture it on hardware
+//   itla_trace replay <trace> [-x speed]
+//       the driver against the recorded module: its writes are checked
+//       against the recorded TX and the recorded RX comes back at the
+//       recorded offsets. -x 1 is real time, -x 10 ten times faster, -x 0
+//       on virtual time (no waiting at all; the default).
+//   itla_trace replay <trace> --sim
+//       the recorded commands into a simulated module at the recorded times;
+//       its replies are compared with the recorded ones
+//   itla_trace scan <trace> [-j threads] [-d scalar|sse2|avx2] [--check]
+//       triage counts for the whole trace (BIP failures, CE, status and XE
+//       per register) using the bulk decoder in host/ITLA_FrameScan.h, split
+//       over threads; --check decodes it with every decoder the CPU has and
+//       compares them with the scalar reference
+// Traces are mapped, not read, so multi-hour captures are fine.
+// Faults for record are those of itla_faultbench: drop noise bip ce xe cip slow.
+//
+// Build (from ITLApY/):
+//   g++ -std=c++20 -O2 -pthread -Ihost -I. host/itla_trace.cpp host/ITLA_TraceFile.cpp
+//       host/ITLA_FrameScan.cpp host/ITLA_Sim.cpp host/Arduino.cpp ITLA_.cpp ITLA_ChannelPlan.cpp
+//       ITLA_TuneProfiler.cpp ITLA_Log.cpp ITLA_Trace.cpp -o itla_trace
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "ITLA_Impl.h"
+#include "ITLA_Sim.h"
+#include "ITLA_Replay.h"
+#include "ITLA_FrameScan.h"
+
+typedef TracingTransport<SimTransport, SimTimestamp> SimTapTransport;
+typedef BasicITLA<SimTapTransport, VirtualClock, SimLogger> TracedSimITLA;
+typedef BasicITLA<ReplayTransport<ScaledClock>, ScaledClock, SimLogger> ReplayITLA;
+typedef BasicITLA<ReplayTransport<SimTimestamp>, VirtualClock, SimLogger> VirtualReplayITLA;
+
+template class BasicITLA<SimTapTransport, VirtualClock, SimLogger>;
+template class BasicITLA<ReplayTransport<ScaledClock>, ScaledClock, SimLogger>;
+template class BasicITLA<ReplayTransport<SimTimestamp>, VirtualClock, SimLogger>;
+
+static const char *kindName(uint8_t kind) {
+    switch (kind) {
+    case TRACE_TX: return "TX";
+    case TRACE_RX: return "RX";
+    case TRACE_BAUD: return "BAUD";
+    case TRACE_START: return "START";
+    }
+    return "?";
+}
+
+static uint32_t baudOf(const TraceRecord &r) {
+    uint32_t b;
+    memcpy(&b, r.data, sizeof(b));
+    return b;
+}
+
+// ---- convert / dump ----
+
+static int dump(const char *path) {
+    TraceFile t;
+    if (!t.open(path)) {
+        fprintf(stderr, "%s\n", t.error());
+        return 1;
+    }
+    TraceTimeline timeline;
+    uint64_t last = 0;
+    uint32_t gaps = 0, lost = 0;
+    for (size_t i = 0; i < t.size(); i++) {
+        const TraceRecord &r = t[i];
+        if (i > 0) {
+            uint16_t expect = (uint16_t)(t[i - 1].seq + 1);
+            if (r.seq != expect && r.kind != TRACE_START) {
+                uint16_t n = (uint16_t)(r.seq - expect);
+                printf("               -- %u record(s) dropped --\n", n);
+                gaps++;
+                lost += n;
+            }
+        }
+        uint64_t at = timeline.unwrap(r);
+        printf("%12.6f +%9llu %-5s", at / 1e6, (unsigned long long)(at - last), kindName(r.kind));
+        last = at;
+        if (r.kind == TRACE_BAUD) {
+            printf(" %u\n", baudOf(r));
+            continue;
+        }
+        for (uint8_t k = 0; k < r.len && k < sizeof(r.data); k++) printf(" %02x", r.data[k]);
+        if (r.len == ITLA_FRAME_LEN && (r.kind == TRACE_TX || r.kind == TRACE_RX)) {
+            printf("%*s reg 0x%02x %s 0x%04x", 3 * (4 - r.len), "", r.data[1],
+                   r.kind == TRACE_TX ? (r.data[0] & 0x01 ? "W" : "R") : "=", r.data[2] << 8 | r.data[3]);
+            if (r.kind == TRACE_RX) printf(" st %u%s", r.data[0] & 0x03, r.data[0] & 0x08 ? " CE" : "");
+            if (!itlaFrameValid(r.data)) printf(" BIP!");
+        }
+        putchar('\n');
+    }
+    printf("%zu records, %.6f s", t.size(), last / 1e6);
+    if (gaps) printf(", %u gap(s), %u record(s) dropped", gaps, lost);
+    putchar('\n');
+    return 0;
+}
+
+// ---- record ----
+
+class FilePrint : public Print {
+public:
+    explicit FilePrint(FILE *f) : f(f) {}
+    size_t write(uint8_t b) override { return fputc(b, f) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buf, size_t len) override { return fwrite(buf, 1, len, f); }
+
+private:
+    FILE *f;
+};
+
+// Yield hook: drain the trace during the driver's waits, as a sketch's loop would
+struct RecordCtx {
+    SimWorld *world;
+    FilePrint *out;
+};
+
+static void recordYield(void *p, unsigned long ms) {
+    RecordCtx *ctx = (RecordCtx *)p;
+    while (itlaTrace.drainBinary(*ctx->out)) {}
+    ctx->world->advance((uint64_t)ms * 1000);
+}
+
+static bool setFault(SimModuleConfig &cfg, const char *arg) {
+    const char *eq = strchr(arg, '=');
+    if (!eq) return false;
+    std::string name(arg, eq - arg);
+    double rate = atof(eq + 1);
+    if (rate < 0 || rate > 1) return false;
+    if (name == "drop") cfg.dropProb = rate;
+    else if (name == "noise") cfg.noiseProb = rate;
+    else if (name == "bip") cfg.bipProb = rate;
+    else if (name == "ce") cfg.ceProb = rate;
+    else if (name == "xe") cfg.xeProb = rate;
+    else if (name == "cip") cfg.cipProb = rate;
+    else if (name == "slow") cfg.slowProb = rate;
+    else return false;
+    return true;
+}
+
+static int record(const char *path, uint64_t seed, uint32_t operations, const SimModuleConfig &cfg) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    FilePrint out(f);
+    SimWorld world;
+    SimModule module(world, seed, cfg);
+    SimTransport line(world, module);
+    SimTapTransport tap(line, SimTimestamp(world));
+    SimEventCounts seen;
+    TracedSimITLA itla(tap, VirtualClock(world), SimLogger(&seen));
+    RecordCtx ctx = {&world, &out};
+    itla.setYieldHook(recordYield, &ctx);
+    SimRandom rng(seed ^ 0x5A5A5A5A5A5A5A5AULL);
+
+    itlaTrace.start((uint32_t)world.nowUs());
+    itla.begin();
+    ModuleProfile prof;
+    if (itla.readProfile(prof)) itla.useProfile(prof);
+    for (uint32_t i = 0; i < operations; i++) {
+        while (itla.linkState() == LINK_LOST) {
+            itla.serviceLink();
+            recordYield(&ctx, 10);
+        }
+        switch (rng.range(0, 9)) {
+        case 0:
+            if (itla.setChannel(rng.range(1, module.channels()))) itla.waitPending();
+            break;
+        case 1:
+            itla.writeRegister(ITLA_REG_POWER, (uint16_t)rng.range(700, 1300));
+            break;
+        case 2:
+            // one short outage per ~100 operations
+            if (rng.chance(0.1)) {
+                module.unplug();
+                world.at(world.nowUs() + rng.range(100000, 2000000), [&module]() { module.plug(); });
+            }
+            break;
+        default:
+            itla.getTemperature();
+            break;
+        }
+        recordYield(&ctx, rng.range(1, 50));
+    }
+    itlaTrace.stop();
+    while (itlaTrace.drainBinary(out)) {}
+    if (fclose(f) != 0) {
+        perror(path);
+        return 1;
+    }
+    printf("%s: %u operations in %.3f s virtual, %u timeouts, %lu record(s) dropped\n", path, operations,
+           world.nowUs() / 1e6, seen[LOG_RX_TIMEOUT], (unsigned long)itlaTrace.dropped());
+    return 0;
+}
+
+// ---- replay into the driver ----
+
+struct ReplayStats {
+    uint32_t ok, failed, stalls;
+};
+
+// Drives the driver through the recorded session: each anchor (the next TX
+// or BAUD record) is due at its recorded time, and the driver call that
+// produces it is made then. wait(us) must bring the driver clock to us.
+template <class Driver, class Line, class Wait>
+static ReplayStats replayAnchors(Driver &itla, Line &line, Wait wait) {
+    ReplayStats s = {};
+    const TraceRecord *r;
+    uint64_t recUs;
+    size_t stuckAt = (size_t)-1;
+    uint32_t stuckFor = 0;
+    while (line.nextAnchor(r, recUs)) {
+        wait(recUs);
+        size_t before = line.position();
+        if (itla.linkState() == LINK_LOST) {
+            itla.serviceLink();   // the recorded driver was probing too
+        } else if (r->kind == TRACE_BAUD) {
+            if (itla.begin()) s.ok++;
+            else s.failed++;
+        } else if (r->len == ITLA_FRAME_LEN) {
+            uint8_t reg = r->data[1];
+            if (r->data[0] & 0x01) itla.writeRegister(reg, (uint16_t)(r->data[2] << 8 | r->data[3]));
+            else itla.readRegister(reg);
+            if (itla.lastStatus() == 0) s.ok++;
+            else s.failed++;
+        }
+        if (line.position() != before) {
+            stuckFor = 0;
+            continue;
+        }
+        // The driver held back (reacquire interval, fail-fast): let time pass
+        if (before == stuckAt && ++stuckFor > 10000) {
+            fprintf(stderr, "replay: driver never produced record %zu, giving up\n", before);
+            break;
+        }
+        stuckAt = before;
+        s.stalls++;
+        wait(recUs + 1000 * stuckFor);
+    }
+    return s;
+}
+
+template <class Line>
+static void printReplay(const TraceFile &t, const Line &line, const ReplayStats &s, const SimEventCounts &seen,
+                        double seconds) {
+    printf("%zu records: %u anchors reproduced, %u mismatched, %u after the end; %u RX bytes served\n", t.size(),
+           line.framesMatched(), line.mismatches(), line.afterEnd(), line.bytesServed());
+    printf("driver: %u ok, %u failed, %u waits for the driver; %u timeouts, %u BIP errors, %u CE\n", s.ok, s.failed,
+           s.stalls, seen[LOG_RX_TIMEOUT], seen[LOG_BIP_ERROR], seen[LOG_CE_FLAG]);
+    printf("%.3f s of driver time\n", seconds);
+}
+
+static int replayDriver(const char *path, double speed) {
+    TraceFile t;
+    if (!t.open(path)) {
+        fprintf(stderr, "%s\n", t.error());
+        return 1;
+    }
+    SimEventCounts seen;
+    auto wall0 = std::chrono::steady_clock::now();
+    if (speed <= 0) {
+        SimWorld world;
+        ReplayTransport<SimTimestamp> line(t, SimTimestamp(world));
+        VirtualReplayITLA itla(line, VirtualClock(world), SimLogger(&seen));
+        ReplayStats s = replayAnchors(itla, line, [&world](uint64_t us) {
+            if (us > world.nowUs()) world.advance(us - world.nowUs());
+        });
+        printReplay(t, line, s, seen, world.nowUs() / 1e6);
+    } else {
+        ScaledClock clock(speed);
+        ReplayTransport<ScaledClock> line(t, clock);
+        ReplayITLA itla(line, clock, SimLogger(&seen));
+        ReplayStats s = replayAnchors(itla, line, [&clock, speed](uint64_t us) {
+            uint64_t now = clock.elapsedUs();
+            if (us > now) std::this_thread::sleep_for(std::chrono::duration<double, std::micro>((us - now) / speed));
+        });
+        printReplay(t, line, s, seen, clock.elapsedUs() / 1e6);
+    }
+    printf("wall %.3f s\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count());
+    return 0;
+}
+
+// ---- replay into the simulator ----
+
+// The recorded commands go straight into a SimModule at their recorded
+// times; each reply is compared with the one recorded after that command
+static int replaySim(const char *path) {
+    TraceFile t;
+    if (!t.open(path)) {
+        fprintf(stderr, "%s\n", t.error());
+        return 1;
+    }
+    // The module listens at the rate of the first command that was answered
+    SimModuleConfig cfg;
+    uint32_t baud = 0;
+    for (size_t i = 0; i + 1 < t.size(); i++) {
+        if (t[i].kind == TRACE_BAUD) baud = baudOf(t[i]);
+        if (t[i].kind == TRACE_TX && t[i + 1].kind == TRACE_RX && baud) {
+            cfg.baud = baud;
+            break;
+        }
+    }
+    SimWorld world;
+    SimModule module(world, 1, cfg);
+
+    struct Exchange {
+        uint8_t cmd[4];
+        uint64_t atUs;
+        std::vector<uint8_t> recorded, simulated;
+        uint64_t recordedUs, simulatedUs;   // last reply byte, from the command
+    };
+    std::vector<Exchange> xs;
+    TraceTimeline timeline;
+    baud = 0;
+    for (size_t i = 0; i < t.size(); i++) {
+        const TraceRecord &r = t[i];
+        uint64_t at = timeline.unwrap(r);
+        if (r.kind == TRACE_BAUD) baud = baudOf(r);
+        else if (r.kind == TRACE_TX && r.len == ITLA_FRAME_LEN) {
+            Exchange x = {{r.data[0], r.data[1], r.data[2], r.data[3]}, at, {}, {}, 0, 0};
+            xs.push_back(x);
+            if (at > world.nowUs()) world.advance(at - world.nowUs());
+            // The module sees the command once its last byte is in, as over SimTransport
+            uint64_t in = baud ? at + (ITLA_FRAME_LEN * 10ULL * 1000000ULL + baud - 1) / baud : at;
+            size_t k = xs.size() - 1;
+            long rate = (long)baud;
+            world.at(in, [&xs, &module, k, rate]() {
+                module.receive(xs[k].cmd, rate, [&xs, k](uint8_t b, uint64_t arrives) {
+                    xs[k].simulatedUs = arrives - xs[k].atUs;
+                    xs[k].simulated.push_back(b);
+                });
+            });
+        } else if (r.kind == TRACE_RX && !xs.empty()) {
+            Exchange &x = xs.back();
+            x.recordedUs = at - x.atUs;
+            for (uint8_t k = 0; k < r.len && k < sizeof(r.data); k++) x.recorded.push_back(r.data[k]);
+        }
+    }
+
+    world.advance(1000000);   // replies to the last command
+
+    uint32_t same = 0, differ = 0, recordedOnly = 0, simOnly = 0, silent = 0, shown = 0;
+    uint64_t recordedSum = 0, simulatedSum = 0;
+    uint32_t timed = 0;
+    for (const Exchange &x : xs) {
+        bool hasR = !x.recorded.empty(), hasS = !x.simulated.empty();
+        if (!hasR && !hasS) silent++;
+        else if (!hasS) recordedOnly++;
+        else if (!hasR) simOnly++;
+        else {
+            timed++;
+            recordedSum += x.recordedUs;
+            simulatedSum += x.simulatedUs;
+            if (x.recorded == x.simulated) {
+                same++;
+                continue;
+            }
+            differ++;
+        }
+        if (!hasR && !hasS) continue;
+        if (shown++ < 20) {
+            printf("%12.6f reg 0x%02x %s:", x.atUs / 1e6, x.cmd[1], x.cmd[0] & 0x01 ? "W" : "R");
+            printf(" recorded");
+            for (uint8_t b : x.recorded) printf(" %02x", b);
+            if (!hasR) printf(" (none)");
+            printf("  sim");
+            for (uint8_t b : x.simulated) printf(" %02x", b);
+            if (!hasS) printf(" (none)");
+            putchar('\n');
+        }
+    }
+    printf("%zu commands at %ld baud: %u same reply, %u different, %u recorded only, %u sim only, "
+           "%u unanswered by both\n", xs.size(), cfg.baud, same, differ, recordedOnly, simOnly, silent);
+    if (timed)
+        printf("reply complete after the command: recorded %.0f us, sim %.0f us on average\n",
+               (double)recordedSum / timed, (double)simulatedSum / timed);
+    return 0;
+}
+
+// ---- scan ----
+
+// Decode alone, without counting: records per second
+static double decodeRate(const TraceFile &t, FrameDecoder d, std::vector<DecodedFrame> &buf) {
+    auto wall0 = std::chrono::steady_clock::now();
+    for (size_t start = 0; start < t.size(); start += buf.size()) {
+        size_t m = t.size() - start < buf.size() ? t.size() - start : buf.size();
+        frameDecode(&t[start], m, buf.data(), d);
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    return wall > 0 ? t.size() / wall : 0.0;
+}
+
+// Every available decoder against the scalar reference, block by block
+static uint64_t checkDecoders(const TraceFile &t) {
+    static const size_t BLOCK = 1 << 16;
+    std::vector<DecodedFrame> ref(BLOCK), other(BLOCK);
+    uint64_t differ = 0;
+    printf("decode scalar %7.1f M records/s\n", decodeRate(t, DECODE_SCALAR, ref) / 1e6);
+    for (FrameDecoder d : {DECODE_SSE2, DECODE_AVX2}) {
+        if (!frameDecoderAvailable(d)) {
+            printf("decode %-6s not available on this CPU\n", frameDecoderName(d));
+            continue;
+        }
+        uint64_t bad = 0;
+        for (size_t start = 0; start < t.size(); start += BLOCK) {
+            size_t m = t.size() - start < BLOCK ? t.size() - start : BLOCK;
+            frameDecode(&t[start], m, ref.data(), DECODE_SCALAR);
+            frameDecode(&t[start], m, other.data(), d);
+            if (memcmp(ref.data(), other.data(), m * sizeof(DecodedFrame)) == 0) continue;
+            for (size_t i = 0; i < m; i++)
+                if (memcmp(&ref[i], &other[i], sizeof(DecodedFrame)) != 0) bad++;
+        }
+        printf("decode %-6s %7.1f M records/s, %llu record(s) differ from scalar\n", frameDecoderName(d),
+               decodeRate(t, d, other) / 1e6, (unsigned long long)bad);
+        differ += bad;
+    }
+    return differ;
+}
+
+static int scan(const char *path, unsigned threads, FrameDecoder d, bool check) {
+    TraceFile t;
+    if (!t.open(path)) {
+        fprintf(stderr, "%s\n", t.error());
+        return 1;
+    }
+    if (!frameDecoderAvailable(d)) {
+        fprintf(stderr, "%s decoder not available on this CPU\n", frameDecoderName(d));
+        return 1;
+    }
+    FrameTriage tr = {};
+    auto wall0 = std::chrono::steady_clock::now();
+    frameTriageParallel(t, threads, tr, d);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+
+    printf("%llu records: %llu TX, %llu RX frames, %llu partial\n", (unsigned long long)tr.records,
+           (unsigned long long)tr.tx, (unsigned long long)tr.rx, (unsigned long long)tr.partial);
+    printf("BIP failures: %llu TX, %llu RX; CE %llu\n", (unsigned long long)tr.txBipBad,
+           (unsigned long long)tr.rxBipBad, (unsigned long long)tr.ce);
+    printf("RX status: OK %llu  XE %llu  AEA %llu  CP %llu\n", (unsigned long long)tr.status[ITLA_ST_OK],
+           (unsigned long long)tr.status[ITLA_ST_XE], (unsigned long long)tr.status[ITLA_ST_AEA],
+           (unsigned long long)tr.status[ITLA_ST_CP]);
+    for (int reg = 0; reg < 256; reg++)
+        if (tr.xeByReg[reg])
+            printf("  reg 0x%02x: %llu XE of %llu\n", reg, (unsigned long long)tr.xeByReg[reg],
+                   (unsigned long long)tr.rxByReg[reg]);
+    double mb = (double)t.size() * sizeof(TraceRecord) / 1e6;
+    printf("%s, %.3f s: %.1f M records/s, %.0f MB/s\n", frameDecoderName(d), wall,
+           wall > 0 ? t.size() / wall / 1e6 : 0.0, wall > 0 ? mb / wall : 0.0);
+    if (check && checkDecoders(t)) return 1;
+    return 0;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: itla_trace convert <console.log> <out.trc>\n"
+                    "       itla_trace dump <trace>\n"
+                    "       itla_trace record <out.trc> [-s seed] [-n operations] [fault=rate ...]\n"
+                    "       itla_trace replay <trace> [-x speed | --sim]\n"
+                    "       itla_trace scan <trace> [-j threads] [-d scalar|sse2|avx2] [--check]\n");
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) return usage();
+    const char *cmd = argv[1], *path = argv[2];
+
+    if (!strcmp(cmd, "convert") && argc == 4) {
+        long n = traceConvert(path, argv[3]);
+        if (n < 0) return 1;
+        printf("%s: %ld records\n", argv[3], n);
+        return 0;
+    }
+    if (!strcmp(cmd, "dump") && argc == 3) return dump(path);
+    if (!strcmp(cmd, "record")) {
+        uint64_t seed = 1;
+        uint32_t operations = 1000;
+        SimModuleConfig cfg;
+        for (int i = 3; i < argc; i++) {
+            bool hasValue = i + 1 < argc;
+            if (!strcmp(argv[i], "-s") && hasValue) seed = strtoull(argv[++i], 0, 0);
+            else if (!strcmp(argv[i], "-n") && hasValue) operations = (uint32_t)strtoul(argv[++i], 0, 0);
+            else if (!setFault(cfg, argv[i])) return usage();
+        }
+        return record(path, seed, operations, cfg);
+    }
+    if (!strcmp(cmd, "replay")) {
+        double speed = 0;
+        bool sim = false;
+        for (int i = 3; i < argc; i++) {
+            if (!strcmp(argv[i], "-x") && i + 1 < argc) speed = atof(argv[++i]);
+            else if (!strcmp(argv[i], "--sim")) sim = true;
+            else return usage();
+        }
+        return sim ? replaySim(path) : replayDriver(path, speed);
+    }
+    if (!strcmp(cmd, "scan")) {
+        unsigned threads = 0;
+        FrameDecoder d = frameDecoderBest();
+        bool check = false;
+        for (int i = 3; i < argc; i++) {
+            if (!strcmp(argv[i], "-j") && i + 1 < argc) threads = (unsigned)strtoul(argv[++i], 0, 0);
+            else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+                const char *name = argv[++i];
+                if (!strcmp(name, "scalar")) d = DECODE_SCALAR;
+                else if (!strcmp(name, "sse2")) d = DECODE_SSE2;
+                else if (!strcmp(name, "avx2")) d = DECODE_AVX2;
+                else return usage();
+            } else if (!strcmp(argv[i], "--check")) check = true;
+            else return usage();
+        }
+        return scan(path, threads, d, check);
+    }
+    return usage();
+}